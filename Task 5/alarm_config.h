@@ -0,0 +1,97 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _ALARM_CONFIG_H_
+#define _ALARM_CONFIG_H_
+
+// Product variants of the alarm. Each variant is a struct of compile-time
+// constants handed to AlarmSystem<> as a template argument, so thresholds
+// fold into immediates and loop bounds are known to the compiler. A variant
+// only has to redefine what differs from the one it derives from.
+//
+// The variant is chosen at build time, e.g. in mbed_app.json:
+//   "macros": ["ALARM_CONFIG=HighTemperatureAlarmConfig"]
+
+//=====[Libraries]=============================================================
+
+#include "sensor_bank.h"
+
+//=====[Declaration of public data types]======================================
+
+struct DefaultAlarmConfig {
+    // Sensing. Channel 0 is the LM35 and channel 1 the MQ2; each channel
+    // uses the threshold of its kind.
+    static constexpr int sensorChannels = 2;
+    static constexpr sensorKind_t sensorKind(int channel)
+    {
+        return channel == 0 ? SENSOR_KIND_TEMPERATURE : SENSOR_KIND_GAS;
+    }
+    static constexpr int averagingSamples = 100;
+    static constexpr int overTempLevelCelsius = 25;
+    static constexpr double gasDetectionThreshold = 0.4;   // fraction of 3.3 V
+
+    // Detector hysteresis and dwell, so a reading hovering at a threshold
+    // does not toggle the detector every tick. Dwell is in detector ticks
+    // (one per sensor block, SENSOR_BLOCK_PERIOD_MS on the board); gas has
+    // none, so a leak is still reported on the first tick above threshold.
+    static constexpr int overTempHysteresisCelsius = 1;
+    static constexpr double gasHysteresis = 0.02;          // fraction of 3.3 V
+    static constexpr int overTempDwellTicks = 4;
+    static constexpr int gasDwellTicks = 0;
+
+    // Per-sample gas detection alongside the windowed average, see
+    // gas_rise_detector.h. A short average trips on gasDetectionThreshold
+    // within a few samples, and a sustained rise over the clean-air
+    // baseline trips before the threshold is reached. Lengths are in
+    // samples (10 ms each at the board's 100 Hz) and divide fastest as
+    // powers of two.
+    static constexpr bool gasRiseDetection = true;
+    static constexpr int gasFastSamples = 8;
+    static constexpr int gasSlopeSamples = 32;
+    static constexpr int gasBaselineSamples = 4096;
+    static constexpr double gasRiseThreshold = 0.1;          // fraction of 3.3 V
+    static constexpr double gasRiseRatePerSample = 0.001;    // 0.1 of 3.3 V per second
+    static constexpr int gasRiseSustainSamples = 10;
+
+    // Alarm LED blink periods, by cause
+    static constexpr int blinkingTimeGasMs = 1000;
+    static constexpr int blinkingTimeOverTempMs = 500;
+    static constexpr int blinkingTimeGasAndOverTempMs = 100;
+
+    // Repeats of a console report or logged event, per zone, within this
+    // window are merged into one summary with a count
+    static constexpr int eventCoalesceWindowMs = 10000;
+
+    // Zones. Each zone has its own channels, alarm latch, deactivation code
+    // and siren output; by default there is one zone holding every channel.
+    static constexpr int zones = 1;
+    static constexpr int sensorZone(int /* channel */) { return 0; }
+    static constexpr int sirenOutputs = 1;
+    static constexpr int zoneSiren(int /* zone */) { return 0; }
+
+    // Deactivation codes. The keypad and console check a code against
+    // every zone and deactivate the zones it belongs to.
+    static constexpr int codeLength = 4;
+    static constexpr const char* zoneCode(int /* zone */) { return "1805"; }
+    static constexpr int maxIncorrectCodes = 5;
+
+    // Matrix keypad
+    static constexpr int keypadRows = 4;
+    static constexpr int keypadCols = 4;
+    static constexpr const char* keypadKeys = "123A456B789C*0#D";   // row by row
+    static constexpr int debounceKeyTimeMs = 40;
+};
+
+// Boiler rooms and kitchens: a higher temperature limit and a shorter window
+// for a faster gas response.
+struct HighTemperatureAlarmConfig : DefaultAlarmConfig {
+    static constexpr int averagingSamples = 50;
+    static constexpr int overTempLevelCelsius = 45;
+};
+
+#ifndef ALARM_CONFIG
+#define ALARM_CONFIG    DefaultAlarmConfig
+#endif
+
+//=====[#include guards - end]=================================================
+
+#endif // _ALARM_CONFIG_H_
@@ -0,0 +1,556 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _ALARM_SYSTEM_H_
+#define _ALARM_SYSTEM_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+#include "alarm_config.h"
+#include "gas_rise_detector.h"
+#include "sensor_bank.h"
+#include "sensor_scaling.h"
+
+//=====[Declaration of public data types]======================================
+
+// Detector transitions reported by detectorsUpdate(), for the console
+typedef enum {
+    ALARM_REPORT_GAS_DET_ON      = 0x01,
+    ALARM_REPORT_OVER_TEMP_ON    = 0x02,
+    ALARM_REPORT_TEST_BUTTON_ON  = 0x04
+} alarmReport_t;
+
+// State changes reported by transitionsUpdate(), for the event log
+typedef enum {
+    ALARM_TRANSITION_ALARM_ON      = 0x01,
+    ALARM_TRANSITION_GAS_DET_ON    = 0x02,
+    ALARM_TRANSITION_OVER_TEMP_ON  = 0x04
+} alarmTransition_t;
+
+typedef enum {
+    CODE_ENTRY_INCOMPLETE,
+    CODE_ENTRY_CORRECT,
+    CODE_ENTRY_INCORRECT
+} codeEntryResult_t;
+
+//=====[Implementations of public functions]===================================
+
+// First channel of the given kind in a configuration, or sensorChannels if
+// there is none
+template <typename Config>
+constexpr int alarmFirstChannelOfKind(sensorKind_t kind)
+{
+    int channel = 0;
+    while (channel < Config::sensorChannels && Config::sensorKind(channel) != kind) {
+        channel++;
+    }
+    return channel;
+}
+
+// Number of channels of the given kind in a configuration
+template <typename Config>
+constexpr int alarmChannelsOfKind(sensorKind_t kind)
+{
+    int count = 0;
+    for (int channel = 0; channel < Config::sensorChannels; channel++) {
+        count += Config::sensorKind(channel) == kind ? 1 : 0;
+    }
+    return count;
+}
+
+// Hash of the values that shape a configuration's saved state, so a state
+// saved by one variant or version is never restored into another
+template <typename Config>
+constexpr uint32_t alarmStateLayout(uint32_t version, uint32_t stateSize)
+{
+    uint32_t values[] = {version, stateSize, (uint32_t)Config::sensorChannels,
+                         (uint32_t)Config::averagingSamples, (uint32_t)Config::zones,
+                         (uint32_t)Config::codeLength};
+    uint32_t hash = 2166136261u;
+    for (uint32_t value : values) {
+        hash = (hash ^ value) * 16777619u;
+    }
+    for (int channel = 0; channel < Config::sensorChannels; channel++) {
+        hash = (hash ^ (uint32_t)Config::sensorKind(channel)) * 16777619u;
+        hash = (hash ^ (uint32_t)Config::sensorZone(channel)) * 16777619u;
+    }
+    return hash;
+}
+
+//=====[Declaration of public classes]=========================================
+
+// Alarm logic and state for one product variant: the sensor bank, per-zone
+// gas and over-temperature detection and alarm latching, the deactivation
+// codes and the blink period selection. Peripherals stay with the caller,
+// which feeds in samples and key presses and acts on the results.
+//
+// Zone state is one flags word per zone, plus the zone codes, in contiguous
+// arrays. Each tick makes one pass over the channels to gather the detector
+// inputs of every zone and one pass over the zones to step their state
+// machines, so the cost grows linearly with channels plus zones.
+template <typename Config>
+class AlarmSystem {
+public:
+    static constexpr int sensorChannels = Config::sensorChannels;
+    static constexpr int averagingSamples = Config::averagingSamples;
+    static constexpr int zones = Config::zones;
+    static constexpr int sirenOutputs = Config::sirenOutputs;
+    static constexpr int codeLength = Config::codeLength;
+    static constexpr uint16_t overTempLevelCounts =
+        lm35CountsAtCelsius(Config::overTempLevelCelsius);
+    static constexpr uint16_t gasDetectionThresholdCounts =
+        adcCountsAtFraction(Config::gasDetectionThreshold);
+    static constexpr uint16_t overTempHysteresisCounts =
+        lm35CountsAtCelsius(Config::overTempLevelCelsius) -
+        lm35CountsAtCelsius(Config::overTempLevelCelsius - Config::overTempHysteresisCelsius);
+    static constexpr uint16_t gasHysteresisCounts = adcCountsAtFraction(Config::gasHysteresis);
+
+    // Channels reported as "the" LM35 and MQ2 readings: the first of each kind
+    static constexpr int lm35Channel = alarmFirstChannelOfKind<Config>(SENSOR_KIND_TEMPERATURE);
+    static constexpr int mq2Channel = alarmFirstChannelOfKind<Config>(SENSOR_KIND_GAS);
+    static constexpr int gasChannels = alarmChannelsOfKind<Config>(SENSOR_KIND_GAS);
+
+    static_assert(lm35Channel < sensorChannels && mq2Channel < sensorChannels,
+                  "the bank needs at least one temperature and one gas channel");
+    static_assert(Config::gasDetectionThreshold > 0.0 && Config::gasDetectionThreshold < 1.0,
+                  "gas threshold is a fraction of full scale");
+    static_assert(Config::overTempHysteresisCelsius >= 0 &&
+                  Config::overTempHysteresisCelsius <= Config::overTempLevelCelsius &&
+                  Config::gasHysteresis >= 0.0 &&
+                  Config::gasHysteresis <= Config::gasDetectionThreshold,
+                  "hysteresis must lie between zero and the threshold");
+    static_assert(Config::overTempDwellTicks >= 0 && Config::overTempDwellTicks < UINT8_MAX &&
+                  Config::gasDwellTicks >= 0 && Config::gasDwellTicks < UINT8_MAX,
+                  "dwell out of range");
+    static_assert(Config::gasRiseSustainSamples >= 0 &&
+                  Config::gasRiseSustainSamples <= UINT8_MAX,
+                  "rise sustain out of range");
+    static_assert(zones > 0 && zones <= UINT16_MAX, "zone count out of range");
+    static_assert(sirenOutputs > 0 && sirenOutputs <= 32, "siren outputs are a 32-bit mask");
+    static_assert(codeLength > 0, "code length must be positive");
+    static_assert(Config::keypadRows * Config::keypadCols <= 16,
+                  "keypadKeys covers at most a 4x4 keypad");
+
+    typedef SensorBank<sensorChannels, averagingSamples> sensorBank_t;
+    typedef GasRiseDetector<gasChannels, Config::gasFastSamples, Config::gasSlopeSamples,
+                            Config::gasBaselineSamples> gasRiseDetector_t;
+
+    // What a warm start carries over a reset: the filters, the detector and
+    // latch states, the zone codes and the incorrect code count. A code
+    // half typed on the keypad is not kept. Only the codes and the count
+    // outlive the sensor readings, see settingsRestore().
+    struct State {
+        typename sensorBank_t::State sensorBank;
+        typename gasRiseDetector_t::State gasRiseDetector;
+        uint16_t zoneFlags[zones];
+        char zoneCodes[zones][codeLength];
+        int32_t incorrectCodes;
+    };
+
+    static constexpr uint32_t stateVersion = 1;
+    static constexpr uint32_t stateLayout =
+        alarmStateLayout<Config>(stateVersion, sizeof(State));
+
+    AlarmSystem()
+    {
+        for (int c = 0; c < sensorChannels; c++) {
+            sensorKind_t kind = Config::sensorKind(c);
+            if (kind == SENSOR_KIND_TEMPERATURE) {
+                sensorBank.channelSet(c, kind, overTempLevelCounts, overTempHysteresisCounts,
+                                      (uint8_t)Config::overTempDwellTicks);
+            } else {
+                sensorBank.channelSet(c, kind, gasDetectionThresholdCounts, gasHysteresisCounts,
+                                      (uint8_t)Config::gasDwellTicks);
+            }
+            channelInputs[c] = kind == SENSOR_KIND_TEMPERATURE ? ZONE_INPUT_OVER_TEMP
+                                                              : ZONE_INPUT_GAS;
+            channelZones[c] = (uint16_t)Config::sensorZone(c);
+        }
+        int gasSlot = 0;
+        for (int c = 0; c < sensorChannels; c++) {
+            if (Config::sensorKind(c) == SENSOR_KIND_GAS) {
+                gasRiseDetector.channelSet(gasSlot, c);
+                gasSlot++;
+            }
+        }
+        gasRiseDetector.thresholdsSet(gasDetectionThresholdCounts,
+                                      gasDetectionThresholdCounts - gasHysteresisCounts,
+                                      adcCountsAtFraction(Config::gasRiseThreshold),
+                                      adcCountsAtFraction(Config::gasRiseRatePerSample),
+                                      (uint8_t)Config::gasRiseSustainSamples);
+        for (int z = 0; z < zones; z++) {
+            zoneSirenMasks[z] = 1u << Config::zoneSiren(z);
+        }
+        reset();
+    }
+
+    void reset()
+    {
+        sensorBank.reset(0);
+        gasRiseDetector.reset();
+        lm35TempCentiC = 0;
+        for (int z = 0; z < zones; z++) {
+            const char* code = Config::zoneCode(z);
+            for (int i = 0; i < codeLength; i++) {
+                zoneCodes[z][i] = code[i];
+            }
+            zoneFlags[z] = 0;
+            zoneReports[z] = 0;
+            zoneTransitions[z] = 0;
+        }
+        for (int i = 0; i < codeLength; i++) {
+            keysPressed[i] = '0';
+        }
+        keysPressedCount = 0;
+        incorrectCodes = 0;
+    }
+
+    void stateSave(State* state) const
+    {
+        sensorBank.stateSave(&state->sensorBank);
+        gasRiseDetector.stateSave(&state->gasRiseDetector);
+        for (int z = 0; z < zones; z++) {
+            state->zoneFlags[z] = zoneFlags[z];
+            for (int i = 0; i < codeLength; i++) {
+                state->zoneCodes[z][i] = zoneCodes[z][i];
+            }
+        }
+        state->incorrectCodes = incorrectCodes;
+    }
+
+    // Takes over a saved state; the next detectorsUpdate() works from the
+    // restored filters. Returns false, after a reset(), if any part of it is
+    // out of range.
+    bool stateRestore(const State& state)
+    {
+        bool valid = state.incorrectCodes >= 0;
+        for (int z = 0; z < zones; z++) {
+            valid = valid && (state.zoneFlags[z] & ~ZONE_FLAGS_ALL) == 0;
+        }
+        if (!valid || !sensorBank.stateRestore(state.sensorBank) ||
+            !gasRiseDetector.stateRestore(state.gasRiseDetector)) {
+            reset();
+            return false;
+        }
+        for (int z = 0; z < zones; z++) {
+            zoneFlags[z] = state.zoneFlags[z];
+            for (int i = 0; i < codeLength; i++) {
+                zoneCodes[z][i] = state.zoneCodes[z][i];
+            }
+        }
+        incorrectCodes = state.incorrectCodes;
+        return true;
+    }
+
+    // Takes over only the zone codes and the incorrect code count, for a
+    // state too old for its filters and latches to describe the present.
+    // Returns false, leaving everything as it was, if the count is out of
+    // range.
+    bool settingsRestore(const State& state)
+    {
+        if (state.incorrectCodes < 0) {
+            return false;
+        }
+        for (int z = 0; z < zones; z++) {
+            for (int i = 0; i < codeLength; i++) {
+                zoneCodes[z][i] = state.zoneCodes[z][i];
+            }
+        }
+        incorrectCodes = state.incorrectCodes;
+        return true;
+    }
+
+    // Feeds a block of frames (one sample per channel, in ADC counts) into
+    // the sensor bank and the per-sample gas detector.
+    template <int N>
+    void framesProcess(const uint16_t (&frames)[N][sensorChannels])
+    {
+        for (int i = 0; i < N; i++) {
+            sensorBank.frameProcess(frames[i]);
+            if (Config::gasRiseDetection) {
+                gasRiseDetector.frameProcess(frames[i]);
+            }
+        }
+    }
+
+    // Evaluates every channel against its threshold and steps every zone.
+    // The test button drives all zones. Returns the alarmReport_t
+    // transitions of all zones combined; zoneReportsGet() has them per zone.
+    uint8_t detectorsUpdate(bool testButton)
+    {
+        uint8_t allReports = 0;
+
+        sensorBank.evaluate();
+        lm35TempCentiC = lm35CountsToCentiCelsius(sensorBank.average(lm35Channel));
+
+        for (int z = 0; z < zones; z++) {
+            zoneInputs[z] = 0;
+        }
+        for (int c = 0; c < sensorChannels; c++) {
+            zoneInputs[channelZones[c]] |= sensorBank.isAbove(c) ? channelInputs[c] : 0;
+        }
+        if (Config::gasRiseDetection) {
+            for (int s = 0; s < gasChannels; s++) {
+                int c = gasRiseDetector.frameChannel(s);
+                zoneInputs[channelZones[c]] |= gasRiseDetector.isTripped(s) ? ZONE_INPUT_GAS : 0;
+            }
+        }
+        for (int z = 0; z < zones; z++) {
+            uint8_t reports;
+            zoneFlags[z] = zoneStep(zoneFlags[z], zoneInputs[z], testButton, &reports);
+            zoneReports[z] = reports;
+            allReports |= reports;
+        }
+        return allReports;
+    }
+
+    // Computes the alarmTransition_t ON transitions of every zone since the
+    // last call. Returns them combined; zoneTransitionsGet() has them per
+    // zone.
+    uint8_t transitionsUpdate()
+    {
+        uint8_t allTransitions = 0;
+
+        for (int z = 0; z < zones; z++) {
+            uint16_t flags = zoneFlags[z];
+            uint8_t transitions = 0;
+
+            if ((flags & ZONE_ALARM) && !(flags & ZONE_LOGGED_ALARM)) {
+                transitions |= ALARM_TRANSITION_ALARM_ON;
+            }
+            if ((flags & ZONE_GAS_CAUSE) && !(flags & ZONE_LOGGED_GAS)) {
+                transitions |= ALARM_TRANSITION_GAS_DET_ON;
+            }
+            if ((flags & ZONE_OVER_TEMP) && !(flags & ZONE_LOGGED_OVER_TEMP)) {
+                transitions |= ALARM_TRANSITION_OVER_TEMP_ON;
+            }
+            flags &= ~(ZONE_LOGGED_ALARM | ZONE_LOGGED_GAS | ZONE_LOGGED_OVER_TEMP);
+            flags |= (flags & ZONE_ALARM) ? ZONE_LOGGED_ALARM : 0;
+            flags |= (flags & ZONE_GAS_CAUSE) ? ZONE_LOGGED_GAS : 0;
+            flags |= (flags & ZONE_OVER_TEMP) ? ZONE_LOGGED_OVER_TEMP : 0;
+            zoneFlags[z] = flags;
+            zoneTransitions[z] = transitions;
+            allTransitions |= transitions;
+        }
+        return allTransitions;
+    }
+
+    // Blink period for the causes of one zone, or 0 when it is not in alarm
+    int blinkingTimeMs(int zone) const
+    {
+        uint16_t flags = zoneFlags[zone];
+        if ((flags & ZONE_GAS_CAUSE) && (flags & ZONE_OVER_TEMP_CAUSE)) {
+            return Config::blinkingTimeGasAndOverTempMs;
+        } else if (flags & ZONE_GAS_CAUSE) {
+            return Config::blinkingTimeGasMs;
+        } else if (flags & ZONE_OVER_TEMP_CAUSE) {
+            return Config::blinkingTimeOverTempMs;
+        }
+        return 0;
+    }
+
+    // Fastest blink period over all zones, for a shared alarm LED
+    int blinkingTimeMs() const
+    {
+        int fastest = 0;
+        for (int z = 0; z < zones; z++) {
+            int period = blinkingTimeMs(z);
+            if (period > 0 && (fastest == 0 || period < fastest)) {
+                fastest = period;
+            }
+        }
+        return fastest;
+    }
+
+    // Bit n set if any zone mapped to siren output n is in alarm
+    uint32_t sirenOutputsActive() const
+    {
+        uint32_t active = 0;
+        for (int z = 0; z < zones; z++) {
+            active |= (zoneFlags[z] & ZONE_ALARM) ? zoneSirenMasks[z] : 0;
+        }
+        return active;
+    }
+
+    // Keypad entry, one key at a time. The code is checked once codeLength
+    // keys have been given.
+    codeEntryResult_t codeKeyEnter(char key)
+    {
+        keysPressed[keysPressedCount] = key;
+        keysPressedCount++;
+        if (keysPressedCount < codeLength) {
+            return CODE_ENTRY_INCOMPLETE;
+        }
+        keysPressedCount = 0;
+        return codeEnter(keysPressed) ? CODE_ENTRY_CORRECT : CODE_ENTRY_INCORRECT;
+    }
+
+    // Drops a code half typed on the keypad
+    void codeKeysClear() { keysPressedCount = 0; }
+
+    // Checks a complete code against every zone and deactivates the zones
+    // it belongs to. Returns false if it matches none.
+    bool codeEnter(const char* keys)
+    {
+        bool matched = false;
+        for (int z = 0; z < zones; z++) {
+            if (codeMatches(z, keys)) {
+                zoneFlags[z] &= ~ZONE_ALARM;
+                matched = true;
+            }
+        }
+        if (matched) {
+            incorrectCodes = 0;
+        } else {
+            incorrectCodes++;
+        }
+        return matched;
+    }
+
+    void codeSet(int zone, const char* keys)
+    {
+        for (int i = 0; i < codeLength; i++) {
+            zoneCodes[zone][i] = keys[i];
+        }
+    }
+
+    static char keypadKey(int row, int col)
+    {
+        return Config::keypadKeys[row * Config::keypadCols + col];
+    }
+
+    bool isAlarmOn() const { return sirenOutputsActive() != 0; }
+    bool isAlarmOn(int zone) const { return (zoneFlags[zone] & ZONE_ALARM) != 0; }
+    bool isBlocked() const { return incorrectCodes >= Config::maxIncorrectCodes; }
+    bool isGasDetected() const
+    {
+        return sensorBank.anyAbove(SENSOR_KIND_GAS) ||
+               (Config::gasRiseDetection && gasRiseDetector.anyTripped());
+    }
+    bool isOverTemp() const { return sensorBank.anyAbove(SENSOR_KIND_TEMPERATURE); }
+    uint8_t zoneReportsGet(int zone) const { return zoneReports[zone]; }
+    uint8_t zoneTransitionsGet(int zone) const { return zoneTransitions[zone]; }
+    uint16_t lm35Counts() const { return sensorBank.average(lm35Channel); }
+    uint16_t mq2Counts() const { return sensorBank.average(mq2Channel); }
+    uint16_t channelCounts(int channel) const { return sensorBank.average(channel); }
+    bool isChannelAbove(int channel) const { return sensorBank.isAbove(channel); }
+    int32_t lm35CentiCelsius() const { return lm35TempCentiC; }
+
+private:
+    // Detector inputs gathered per zone
+    enum {
+        ZONE_INPUT_GAS        = 0x01,
+        ZONE_INPUT_OVER_TEMP  = 0x02
+    };
+
+    // Zone flags word
+    enum {
+        ZONE_ALARM             = 0x0001,
+        ZONE_GAS_CAUSE         = 0x0002,    // gas cause of the active alarm
+        ZONE_OVER_TEMP         = 0x0004,    // raw over-temperature detector
+        ZONE_OVER_TEMP_CAUSE   = 0x0008,    // over-temperature cause of the active alarm
+        ZONE_LAST_GAS          = 0x0010,
+        ZONE_LAST_OVER_TEMP    = 0x0020,
+        ZONE_LOGGED_ALARM      = 0x0040,    // last states seen by transitionsUpdate()
+        ZONE_LOGGED_GAS        = 0x0080,
+        ZONE_LOGGED_OVER_TEMP  = 0x0100,
+        ZONE_FLAGS_ALL         = 0x01FF
+    };
+
+    // One tick of a zone's detector and latch logic
+    static uint16_t zoneStep(uint16_t flags, uint8_t inputs, bool testButton,
+                             uint8_t* reports)
+    {
+        bool alarm = flags & ZONE_ALARM;
+        bool gasCause;
+        bool overTemp = inputs & ZONE_INPUT_OVER_TEMP;
+        bool overTempCause;
+        bool lastGas = flags & ZONE_LAST_GAS;
+        bool lastOverTemp = flags & ZONE_LAST_OVER_TEMP;
+        bool loggedAlarm = flags & ZONE_LOGGED_ALARM;
+
+        *reports = 0;
+        if (inputs & ZONE_INPUT_GAS) {
+            gasCause = true;
+            if (!lastGas) {
+                *reports |= ALARM_REPORT_GAS_DET_ON;
+            }
+            if (!loggedAlarm) {
+                alarm = true;
+            }
+        } else {
+            gasCause = false;
+        }
+        lastGas = gasCause;
+
+        overTempCause = overTemp;
+        if (overTemp && !lastOverTemp) {
+            *reports |= ALARM_REPORT_OVER_TEMP_ON;
+        }
+        lastOverTemp = overTemp;
+
+        if (testButton) {
+            overTempCause = true;
+            gasCause = true;
+            if (!lastGas) {
+                *reports |= ALARM_REPORT_GAS_DET_ON;
+            }
+            if (!lastOverTemp) {
+                *reports |= ALARM_REPORT_OVER_TEMP_ON;
+            }
+            if (!loggedAlarm) {
+                alarm = true;
+                *reports |= ALARM_REPORT_TEST_BUTTON_ON;
+            }
+            lastGas = true;
+            lastOverTemp = true;
+        }
+
+        if (!alarm) {
+            gasCause = false;
+            overTempCause = false;
+            lastGas = false;
+            lastOverTemp = false;
+        }
+
+        return (uint16_t)((flags & (ZONE_LOGGED_ALARM | ZONE_LOGGED_GAS | ZONE_LOGGED_OVER_TEMP)) |
+                          (alarm ? ZONE_ALARM : 0) |
+                          (gasCause ? ZONE_GAS_CAUSE : 0) |
+                          (overTemp ? ZONE_OVER_TEMP : 0) |
+                          (overTempCause ? ZONE_OVER_TEMP_CAUSE : 0) |
+                          (lastGas ? ZONE_LAST_GAS : 0) |
+                          (lastOverTemp ? ZONE_LAST_OVER_TEMP : 0));
+    }
+
+    bool codeMatches(int zone, const char* keys) const
+    {
+        for (int i = 0; i < codeLength; i++) {
+            if (zoneCodes[zone][i] != keys[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    sensorBank_t sensorBank;
+    gasRiseDetector_t gasRiseDetector;
+    uint8_t channelInputs[sensorChannels];     // ZONE_INPUT_* bit of each channel
+    uint16_t channelZones[sensorChannels];
+    int32_t lm35TempCentiC;                    // 0.01 °C, from lm35Channel
+
+    uint16_t zoneFlags[zones];
+    uint8_t zoneInputs[zones];                 // ZONE_INPUT_* gathered this tick
+    uint8_t zoneReports[zones];
+    uint8_t zoneTransitions[zones];
+    uint32_t zoneSirenMasks[zones];
+    char zoneCodes[zones][codeLength];
+
+    char keysPressed[codeLength];
+    int keysPressedCount;
+    int incorrectCodes;
+};
+
+//=====[#include guards - end]=================================================
+
+#endif // _ALARM_SYSTEM_H_
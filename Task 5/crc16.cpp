@@ -0,0 +1,24 @@
+//=====[Libraries]=============================================================
+
+#include "crc16.h"
+
+//=====[Declaration and initialization of private global variables]============
+
+// One entry per 4-bit value: a 32-byte table, two lookups per byte
+static const uint16_t crcNibbleTable[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+//=====[Implementations of public functions]===================================
+
+uint16_t crc16Update(uint16_t crc, const void* data, size_t length)
+{
+    const uint8_t* bytes = (const uint8_t*)data;
+
+    for (size_t i = 0; i < length; i++) {
+        crc = (uint16_t)((crc << 4) ^ crcNibbleTable[(crc >> 12) ^ (bytes[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ crcNibbleTable[(crc >> 12) ^ (bytes[i] & 0x0F)]);
+    }
+    return crc;
+}
@@ -0,0 +1,24 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _CRC16_H_
+#define _CRC16_H_
+
+//=====[Libraries]=============================================================
+
+#include <stddef.h>
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+#define CRC16_INITIAL_VALUE    0xFFFF
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+// CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF, no
+// reflection, no final xor). Pass the previous result as crc to continue
+// over several buffers. The check value for "123456789" is 0x29B1.
+uint16_t crc16Update(uint16_t crc, const void* data, size_t length);
+
+//=====[#include guards - end]=================================================
+
+#endif // _CRC16_H_
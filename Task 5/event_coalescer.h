@@ -0,0 +1,83 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _EVENT_COALESCER_H_
+#define _EVENT_COALESCER_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public classes]=========================================
+
+// Rate limit for repeated events, one window per key. The first occurrence
+// of a key passes straight through and opens a window; further occurrences
+// inside it are only counted, and flush() hands the count on as a single
+// summary when the window closes. A key that keeps repeating gets one
+// summary per window, so the output is bounded whatever the input rate.
+//
+// Times are in milliseconds and may wrap. Call flush() before occur() on
+// every tick, so a closed window is summarized before a new one opens.
+template <int Keys>
+class EventCoalescer {
+public:
+    static_assert(Keys > 0, "coalescer needs at least one key");
+
+    explicit EventCoalescer(uint32_t windowMs) : windowMs(windowMs)
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        for (int key = 0; key < Keys; key++) {
+            windowEndsMs[key] = 0;
+            repeats[key] = 0;
+            open[key] = false;
+        }
+    }
+
+    // Returns true if this occurrence is to be reported now, false if it
+    // was merged into the key's open window.
+    bool occur(int key, uint32_t nowMs)
+    {
+        if (open[key] && (int32_t)(nowMs - windowEndsMs[key]) < 0) {
+            if (repeats[key] < UINT16_MAX) {
+                repeats[key]++;
+            }
+            return false;
+        }
+        open[key] = true;
+        windowEndsMs[key] = nowMs + windowMs;
+        repeats[key] = 0;
+        return true;
+    }
+
+    // Calls summary(key, count) for every window that has closed with
+    // merged occurrences, and starts the next window of that key.
+    template <typename Callback>
+    void flush(uint32_t nowMs, Callback summary)
+    {
+        for (int key = 0; key < Keys; key++) {
+            if (!open[key] || (int32_t)(nowMs - windowEndsMs[key]) < 0) {
+                continue;
+            }
+            if (repeats[key] == 0) {
+                open[key] = false;
+                continue;
+            }
+            summary(key, repeats[key]);
+            repeats[key] = 0;
+            windowEndsMs[key] = nowMs + windowMs;
+        }
+    }
+
+private:
+    uint32_t windowMs;
+    uint32_t windowEndsMs[Keys];
+    uint16_t repeats[Keys];
+    bool open[Keys];
+};
+
+//=====[#include guards - end]=================================================
+
+#endif // _EVENT_COALESCER_H_
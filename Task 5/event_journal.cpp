@@ -0,0 +1,295 @@
+//=====[Libraries]=============================================================
+
+#include <stddef.h>
+
+#include "mbed.h"
+#include "FlashIAPBlockDevice.h"
+
+#include "event_journal.h"
+
+//=====[Declaration of private defines]========================================
+
+#define RECORD_SIZE    sizeof(eventJournalRecord_t)
+
+//=====[Declaration of private data types]=====================================
+
+// Sparse index: one entry per erase sector, kept in RAM.
+typedef struct sectorIndex {
+    uint32_t firstSeconds;
+    uint32_t lastSeconds;
+    uint32_t codeMask;
+} sectorIndex_t;
+
+//=====[Declaration and initialization of private global variables]============
+
+static FlashIAPBlockDevice journalDevice(EVENT_JOURNAL_FLASH_ADDRESS,
+                                         EVENT_JOURNAL_FLASH_SIZE);
+
+static bool journalMounted = false;
+static uint32_t sectorSize = 0;
+static uint32_t numberOfSectors = 0;
+static uint32_t recordsPerSector = 0;
+static uint32_t nextSequence = 0;
+static sectorIndex_t sectorIndexes[EVENT_JOURNAL_MAX_SECTORS];
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static uint16_t recordChecksum(const eventJournalRecord_t* record);
+static bool readSlot(uint32_t slot, eventJournalRecord_t* record);
+static bool slotIsErased(uint32_t slot);
+static void sectorIndexReset(uint32_t sector);
+static void sectorIndexAdd(uint32_t sector, const eventJournalRecord_t* record);
+
+//=====[Implementations of public functions]===================================
+
+bool eventJournalInit()
+{
+    eventJournalRecord_t record;
+    uint32_t newestSector = 0;
+    uint32_t newestFirstSequence = 0;
+    bool found = false;
+
+    journalMounted = false;
+    if (journalDevice.init() != 0) {
+        return false;
+    }
+    sectorSize = journalDevice.get_erase_size(0);
+    numberOfSectors = journalDevice.size() / sectorSize;
+    recordsPerSector = sectorSize / RECORD_SIZE;
+    if (numberOfSectors < 2 || numberOfSectors > EVENT_JOURNAL_MAX_SECTORS ||
+        journalDevice.get_program_size() > RECORD_SIZE) {
+        return false;
+    }
+
+    // Rebuild the index and find the sector written last. A slot torn by a
+    // reset during a write does not read but is not erased either; it is
+    // skipped, and the records after it still count.
+    for (uint32_t sector = 0; sector < numberOfSectors; sector++) {
+        bool sectorFound = false;
+        sectorIndexReset(sector);
+        for (uint32_t i = 0; i < recordsPerSector; i++) {
+            uint32_t slot = sector * recordsPerSector + i;
+            if (!readSlot(slot, &record)) {
+                if (slotIsErased(slot)) {
+                    break;
+                }
+                continue;
+            }
+            sectorIndexAdd(sector, &record);
+            if (!sectorFound) {
+                uint32_t firstSequence = record.sequence - i;
+                sectorFound = true;
+                if (!found || firstSequence > newestFirstSequence) {
+                    newestSector = sector;
+                    newestFirstSequence = firstSequence;
+                    found = true;
+                }
+            }
+        }
+    }
+
+    // Append at the first erased slot, so a torn slot is left behind as a
+    // gap in the sequence instead of being programmed over
+    nextSequence = 0;
+    if (found) {
+        nextSequence = newestFirstSequence;
+        uint32_t slot = newestSector * recordsPerSector;
+        while (nextSequence - newestFirstSequence < recordsPerSector && !slotIsErased(slot)) {
+            nextSequence++;
+            slot++;
+        }
+    }
+
+    journalMounted = true;
+    return true;
+}
+
+bool eventJournalAppend(uint32_t seconds, uint8_t code, uint16_t zone,
+                        uint16_t lm35Reading, uint16_t mq2Reading)
+{
+    eventJournalRecord_t record;
+
+    if (!journalMounted) {
+        return false;
+    }
+
+    uint32_t slot = nextSequence % (numberOfSectors * recordsPerSector);
+    uint32_t sector = slot / recordsPerSector;
+    if (slot % recordsPerSector == 0) {
+        // Entering a sector: erase it, dropping its (oldest) records
+        if (journalDevice.erase(sector * sectorSize, sectorSize) != 0) {
+            return false;
+        }
+        sectorIndexReset(sector);
+    }
+
+    record.sequence = nextSequence;
+    record.seconds = seconds;
+    record.code = code;
+    record.zone = zone < UINT8_MAX ? (uint8_t)zone : UINT8_MAX;
+    record.lm35Reading = lm35Reading;
+    record.mq2Reading = mq2Reading;
+    record.checksum = recordChecksum(&record);
+
+    if (journalDevice.program(&record, slot * RECORD_SIZE, RECORD_SIZE) != 0) {
+        return false;
+    }
+    sectorIndexAdd(sector, &record);
+    nextSequence++;
+    return true;
+}
+
+uint32_t eventJournalOldest()
+{
+    uint32_t recordsInCurrentSector;
+    uint32_t retained;
+
+    if (!journalMounted) {
+        return 0;
+    }
+    recordsInCurrentSector = nextSequence % recordsPerSector;
+    if (recordsInCurrentSector == 0 && nextSequence > 0) {
+        recordsInCurrentSector = recordsPerSector;
+    }
+    retained = (numberOfSectors - 1) * recordsPerSector + recordsInCurrentSector;
+    return nextSequence > retained ? nextSequence - retained : 0;
+}
+
+uint32_t eventJournalNext()
+{
+    return nextSequence;
+}
+
+bool eventJournalRead(uint32_t sequence, eventJournalRecord_t* record)
+{
+    if (!journalMounted || sequence < eventJournalOldest() || sequence >= nextSequence) {
+        return false;
+    }
+    return readSlot(sequence % (numberOfSectors * recordsPerSector), record) &&
+           record->sequence == sequence;
+}
+
+uint32_t eventJournalSeek(uint32_t fromSeconds)
+{
+    eventJournalRecord_t record;
+    uint32_t sequence = eventJournalOldest();
+
+    // Skip whole sectors that end before fromSeconds
+    while (sequence < nextSequence) {
+        uint32_t sector = (sequence / recordsPerSector) % numberOfSectors;
+        if (sectorIndexes[sector].lastSeconds >= fromSeconds) {
+            break;
+        }
+        sequence = (sequence / recordsPerSector + 1) * recordsPerSector;
+    }
+
+    if (sequence >= nextSequence) {
+        return nextSequence;
+    }
+
+    // Records are in time order within the sector, so binary search it. A
+    // record that does not read ends the search like a later one would.
+    uint32_t low = sequence;
+    uint32_t high = (sequence / recordsPerSector + 1) * recordsPerSector;
+    if (high > nextSequence) {
+        high = nextSequence;
+    }
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        if (eventJournalRead(middle, &record) && record.seconds < fromSeconds) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+int eventJournalLast(uint8_t code, eventJournalRecord_t* records, int maxRecords)
+{
+    eventJournalRecord_t record;
+    uint32_t oldest = eventJournalOldest();
+    uint32_t sequence = nextSequence;
+    int numberOfRecords = 0;
+
+    while (sequence > oldest && numberOfRecords < maxRecords) {
+        uint32_t sectorStart = ((sequence - 1) / recordsPerSector) * recordsPerSector;
+        uint32_t sector = (sectorStart / recordsPerSector) % numberOfSectors;
+        if (sectorStart < oldest) {
+            sectorStart = oldest;
+        }
+
+        if (!(sectorIndexes[sector].codeMask & (1u << code))) {
+            sequence = sectorStart;
+            continue;
+        }
+        while (sequence > sectorStart && numberOfRecords < maxRecords) {
+            sequence--;
+            if (eventJournalRead(sequence, &record) && record.code == code) {
+                records[numberOfRecords++] = record;
+            }
+        }
+    }
+    return numberOfRecords;
+}
+
+uint32_t eventJournalFootprintBytes()
+{
+    return sizeof(journalDevice) + sizeof(sectorIndexes);
+}
+
+//=====[Implementations of private functions]==================================
+
+static uint16_t recordChecksum(const eventJournalRecord_t* record)
+{
+    const uint8_t* bytes = (const uint8_t*)record;
+    uint16_t checksum = 0x5AA5;
+
+    for (size_t i = 0; i < offsetof(eventJournalRecord_t, checksum); i++) {
+        checksum = (uint16_t)((checksum << 1) | (checksum >> 15)) ^ bytes[i];
+    }
+    return checksum;
+}
+
+// False for an erased slot or a torn (partially programmed) record.
+static bool readSlot(uint32_t slot, eventJournalRecord_t* record)
+{
+    if (journalDevice.read(record, slot * RECORD_SIZE, RECORD_SIZE) != 0) {
+        return false;
+    }
+    return record->sequence != EVENT_JOURNAL_INVALID &&
+           record->checksum == recordChecksum(record);
+}
+
+static bool slotIsErased(uint32_t slot)
+{
+    uint8_t bytes[RECORD_SIZE];
+
+    if (journalDevice.read(bytes, slot * RECORD_SIZE, RECORD_SIZE) != 0) {
+        return false;
+    }
+    for (size_t i = 0; i < RECORD_SIZE; i++) {
+        if (bytes[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void sectorIndexReset(uint32_t sector)
+{
+    sectorIndexes[sector].firstSeconds = EVENT_JOURNAL_INVALID;
+    sectorIndexes[sector].lastSeconds = 0;
+    sectorIndexes[sector].codeMask = 0;
+}
+
+static void sectorIndexAdd(uint32_t sector, const eventJournalRecord_t* record)
+{
+    if (record->seconds < sectorIndexes[sector].firstSeconds) {
+        sectorIndexes[sector].firstSeconds = record->seconds;
+    }
+    if (record->seconds > sectorIndexes[sector].lastSeconds) {
+        sectorIndexes[sector].lastSeconds = record->seconds;
+    }
+    sectorIndexes[sector].codeMask |= 1u << (record->code & 31);
+}
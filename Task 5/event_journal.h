@@ -0,0 +1,68 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _EVENT_JOURNAL_H_
+#define _EVENT_JOURNAL_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+// Flash region reserved for the journal: the last two 128 KB sectors of the
+// NUCLEO-F429ZI's 2 MB flash. Must be a whole number of erase sectors.
+#ifndef EVENT_JOURNAL_FLASH_ADDRESS
+#define EVENT_JOURNAL_FLASH_ADDRESS    0x081C0000
+#endif
+#ifndef EVENT_JOURNAL_FLASH_SIZE
+#define EVENT_JOURNAL_FLASH_SIZE       (256 * 1024)
+#endif
+
+#define EVENT_JOURNAL_MAX_SECTORS      16
+#define EVENT_JOURNAL_INVALID          0xFFFFFFFFu
+
+//=====[Declaration of public data types]======================================
+
+// Fixed-size record, stored as is. Text is only produced when a record is
+// queried.
+typedef struct eventJournalRecord {
+    uint32_t sequence;
+    uint32_t seconds;
+    uint8_t code;
+    uint8_t zone;              // 255 for zone 255 and above; 0 in older records
+    uint16_t lm35Reading;      // AnalogIn::read_u16() scale
+    uint16_t mq2Reading;       // AnalogIn::read_u16() scale
+    uint16_t checksum;
+} eventJournalRecord_t;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+// Mounts the journal and rebuilds the per-sector time/code index. Returns
+// false if the storage is not usable; appends are then ignored.
+bool eventJournalInit();
+
+bool eventJournalAppend(uint32_t seconds, uint8_t code, uint16_t zone,
+                        uint16_t lm35Reading, uint16_t mq2Reading);
+
+// Records are addressed by sequence number, from oldest to next (exclusive).
+uint32_t eventJournalOldest();
+uint32_t eventJournalNext();
+bool eventJournalRead(uint32_t sequence, eventJournalRecord_t* record);
+
+// First retained sequence whose timestamp is at or after fromSeconds: the
+// sector index finds the sector, a binary search the record in it, so a
+// seek reads about log2(records per sector) records. Assumes the RTC is not
+// set backwards.
+uint32_t eventJournalSeek(uint32_t fromSeconds);
+
+// Copies up to maxRecords records with the given event code, newest first.
+// Sectors whose index shows no such code are skipped without being read.
+int eventJournalLast(uint8_t code, eventJournalRecord_t* records, int maxRecords);
+
+// Static RAM taken by the sector index and the flash device, for the
+// footprint report
+uint32_t eventJournalFootprintBytes();
+
+//=====[#include guards - end]=================================================
+
+#endif // _EVENT_JOURNAL_H_
@@ -0,0 +1,131 @@
+//=====[Libraries]=============================================================
+
+#include <atomic>
+
+#include "event_log.h"
+
+//=====[Declaration of private defines]========================================
+
+#define EVENT_LOG_INDEX_MASK    (EVENT_LOG_CAPACITY - 1)
+#define EVENT_LOG_SLOT_BUSY     0xFFFFFFFFu
+
+static_assert((EVENT_LOG_CAPACITY & EVENT_LOG_INDEX_MASK) == 0,
+              "EVENT_LOG_CAPACITY must be a power of two");
+
+//=====[Declaration of private data types]=====================================
+
+// The slot sequence works as a per-slot seqlock: it holds the sequence
+// number of the stored event, or EVENT_LOG_SLOT_BUSY while it is rewritten.
+typedef struct eventLogSlot {
+    std::atomic<uint32_t> sequence;
+    eventLogEntry_t entry;
+} eventLogSlot_t;
+
+//=====[Declaration and initialization of private global variables]============
+
+static eventLogSlot_t slots[EVENT_LOG_CAPACITY];
+static std::atomic<uint32_t> head(0);
+static std::atomic<uint32_t> dropped(0);
+static std::atomic<uint32_t> clockSeconds(0);
+
+static constexpr uint32_t eventLogRamBytes =
+    sizeof(slots) + sizeof(head) + sizeof(dropped) + sizeof(clockSeconds);
+static_assert(eventLogRamBytes <= EVENT_LOG_RAM_BUDGET,
+              "event log exceeds EVENT_LOG_RAM_BUDGET for this layout");
+
+static const char* const eventCodeNames[EVENT_NUMBER_OF_CODES] = {
+    "ALARM_ON",
+    "GAS_DET_ON",
+    "OVER_TEMP_ON",
+};
+
+//=====[Implementations of public functions]===================================
+
+void eventLogInit()
+{
+    for (int i = 0; i < EVENT_LOG_CAPACITY; i++) {
+        slots[i].sequence.store(EVENT_LOG_SLOT_BUSY, std::memory_order_relaxed);
+    }
+    dropped.store(0, std::memory_order_relaxed);
+    head.store(0, std::memory_order_release);
+}
+
+void eventLogClockUpdate(time_t seconds)
+{
+    clockSeconds.store((uint32_t)seconds, std::memory_order_relaxed);
+}
+
+void eventLogPublish(eventCode_t code, uint16_t zone, uint32_t count)
+{
+    uint32_t sequence = head.load(std::memory_order_relaxed);
+    eventLogSlot_t* slot = &slots[sequence & EVENT_LOG_INDEX_MASK];
+
+    slot->sequence.store(EVENT_LOG_SLOT_BUSY, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot->entry.seconds = clockSeconds.load(std::memory_order_relaxed);
+    slot->entry.code = (uint8_t)code;
+    slot->entry.count = count < UINT8_MAX ? (uint8_t)count : UINT8_MAX;
+    slot->entry.zone = zone;
+    slot->sequence.store(sequence, std::memory_order_release);
+    head.store(sequence + 1, std::memory_order_release);
+}
+
+uint32_t eventLogOldestCursor()
+{
+    uint32_t newest = head.load(std::memory_order_acquire);
+    return newest > EVENT_LOG_CAPACITY ? newest - EVENT_LOG_CAPACITY : 0;
+}
+
+uint32_t eventLogNewestCursor()
+{
+    return head.load(std::memory_order_acquire);
+}
+
+bool eventLogRead(uint32_t* cursor, eventLogEntry_t* entry)
+{
+    while (true) {
+        uint32_t newest = head.load(std::memory_order_acquire);
+        if (*cursor == newest) {
+            return false;
+        }
+        if (newest - *cursor > EVENT_LOG_CAPACITY) {
+            dropped.fetch_add(newest - EVENT_LOG_CAPACITY - *cursor,
+                              std::memory_order_relaxed);
+            *cursor = newest - EVENT_LOG_CAPACITY;
+        }
+
+        eventLogSlot_t* slot = &slots[*cursor & EVENT_LOG_INDEX_MASK];
+        if (slot->sequence.load(std::memory_order_acquire) == *cursor) {
+            eventLogEntry_t copy = slot->entry;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot->sequence.load(std::memory_order_relaxed) == *cursor) {
+                *entry = copy;
+                (*cursor)++;
+                return true;
+            }
+        }
+        // Overwritten while being read: the next pass skips past it
+        if (head.load(std::memory_order_acquire) - *cursor <= EVENT_LOG_CAPACITY) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            (*cursor)++;
+        }
+    }
+}
+
+uint32_t eventLogDropped()
+{
+    return dropped.load(std::memory_order_relaxed);
+}
+
+uint32_t eventLogFootprintBytes()
+{
+    return eventLogRamBytes;
+}
+
+const char* eventLogCodeName(uint8_t code)
+{
+    if (code >= EVENT_NUMBER_OF_CODES) {
+        return "UNKNOWN";
+    }
+    return eventCodeNames[code];
+}
@@ -0,0 +1,72 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _EVENT_LOG_H_
+#define _EVENT_LOG_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+#include <time.h>
+
+#include "memory_layout.h"
+
+//=====[Declaration of public defines]=========================================
+
+// Number of retained events; must be a power of two.
+#ifndef EVENT_LOG_CAPACITY
+#if COMPACT_LAYOUT
+#define EVENT_LOG_CAPACITY    64
+#else
+#define EVENT_LOG_CAPACITY    1024
+#endif
+#endif
+
+//=====[Declaration of public data types]======================================
+
+typedef enum {
+    EVENT_ALARM_ON,
+    EVENT_GAS_DET_ON,
+    EVENT_OVER_TEMP_ON,
+    EVENT_NUMBER_OF_CODES
+} eventCode_t;
+
+// count is the number of occurrences the entry stands for: 1, or the
+// repeats merged into one summary by the publisher (saturates at 255).
+typedef struct eventLogEntry {
+    uint32_t seconds;
+    uint8_t code;
+    uint8_t count;
+    uint16_t zone;
+} eventLogEntry_t;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+void eventLogInit();
+
+// Events are stamped with the seconds value last given here, so publishing
+// does not have to call time(), which is not interrupt safe. Call it from
+// thread context at least once a second.
+void eventLogClockUpdate(time_t seconds);
+
+// Wait-free single-producer publish. Safe from one ISR or one thread, never
+// blocks and never disables interrupts; when the log is full the oldest
+// event is overwritten.
+void eventLogPublish(eventCode_t code, uint16_t zone, uint32_t count);
+
+// Wait-free readers. Each reader owns a cursor (a sequence number) and any
+// number of readers may run concurrently with the producer. Events that
+// were overwritten before a reader reached them are skipped and added to
+// the dropped counter.
+uint32_t eventLogOldestCursor();
+uint32_t eventLogNewestCursor();
+bool eventLogRead(uint32_t* cursor, eventLogEntry_t* entry);
+
+uint32_t eventLogDropped();
+const char* eventLogCodeName(uint8_t code);
+
+// Static RAM taken by the log, for the footprint report
+uint32_t eventLogFootprintBytes();
+
+//=====[#include guards - end]=================================================
+
+#endif // _EVENT_LOG_H_
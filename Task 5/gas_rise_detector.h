@@ -0,0 +1,192 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _GAS_RISE_DETECTOR_H_
+#define _GAS_RISE_DETECTOR_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+#define GAS_RISE_FRACTION_BITS    12     // filter states are counts in Q12
+
+//=====[Declaration of public classes]=========================================
+
+// Per-sample gas detection for a set of channels, with O(1) work and no
+// sample storage per channel. Each channel keeps three exponential moving
+// averages of its ADC counts:
+//
+//   fast      FastSamples long, the level compared with the thresholds
+//   slow      SlopeSamples long; fast - slow is proportional to the slope,
+//             (SlopeSamples - FastSamples) samples' worth of rise on a ramp
+//   baseline  BaselineSamples long, the clean-air level. It follows slow
+//             drift such as sensor warm-up, drops straight to any lower
+//             level, and holds still while the reading is rising.
+//
+// A channel trips when the fast level exceeds the level threshold, or when
+// it has risen more than the rise threshold above the baseline while the
+// slope has stayed above the rate threshold for sustain samples in a row.
+// It clears once the level is at or below the clear level and the rise has
+// fallen to half the rise threshold. A plateau below the level threshold is
+// absorbed into the baseline over about BaselineSamples and then clears.
+template <int Slots, int FastSamples, int SlopeSamples, int BaselineSamples>
+class GasRiseDetector {
+public:
+    static_assert(Slots > 0, "detector needs at least one channel");
+    static_assert(FastSamples > 0 && FastSamples < SlopeSamples &&
+                  SlopeSamples < BaselineSamples,
+                  "filters must go from fast to slow");
+
+    // Filter and trip states, for a warm start
+    struct State {
+        int32_t fast[Slots];
+        int32_t slow[Slots];
+        int32_t baseline[Slots];
+        uint8_t sustained[Slots];
+        uint8_t tripped[Slots];
+        uint8_t primed;
+    };
+
+    GasRiseDetector()
+    {
+        for (int s = 0; s < Slots; s++) {
+            frameChannels[s] = 0;
+        }
+        thresholdsSet(UINT16_MAX, UINT16_MAX, UINT16_MAX, UINT16_MAX, UINT8_MAX);
+        reset();
+    }
+
+    // The filters start from the first sample after a reset.
+    void reset()
+    {
+        for (int s = 0; s < Slots; s++) {
+            fast[s] = 0;
+            slow[s] = 0;
+            baseline[s] = 0;
+            sustained[s] = 0;
+            tripped[s] = 0;
+        }
+        primed = false;
+    }
+
+    void stateSave(State* state) const
+    {
+        for (int s = 0; s < Slots; s++) {
+            state->fast[s] = fast[s];
+            state->slow[s] = slow[s];
+            state->baseline[s] = baseline[s];
+            state->sustained[s] = sustained[s];
+            state->tripped[s] = tripped[s];
+        }
+        state->primed = primed;
+    }
+
+    // Returns false, leaving the detector as it was, if the state is out of
+    // range.
+    bool stateRestore(const State& state)
+    {
+        for (int s = 0; s < Slots; s++) {
+            if (state.fast[s] < 0 || state.slow[s] < 0 || state.baseline[s] < 0 ||
+                state.baseline[s] > state.fast[s] || state.tripped[s] > 1) {
+                return false;
+            }
+        }
+        for (int s = 0; s < Slots; s++) {
+            fast[s] = state.fast[s];
+            slow[s] = state.slow[s];
+            baseline[s] = state.baseline[s];
+            sustained[s] = state.sustained[s];
+            tripped[s] = state.tripped[s];
+        }
+        primed = state.primed != 0;
+        return true;
+    }
+
+    // Slot s watches channel frameChannel of each frame.
+    void channelSet(int slot, int frameChannel)
+    {
+        frameChannels[slot] = (uint16_t)frameChannel;
+    }
+
+    // All in ADC counts; ratePerSample is the slope to sustain.
+    void thresholdsSet(uint16_t levelCounts, uint16_t clearLevelCounts, uint16_t riseCounts,
+                       uint16_t ratePerSampleCounts, uint8_t sustainSamples)
+    {
+        level = (int32_t)levelCounts << GAS_RISE_FRACTION_BITS;
+        clearLevel = (int32_t)clearLevelCounts << GAS_RISE_FRACTION_BITS;
+        rise = (int32_t)riseCounts << GAS_RISE_FRACTION_BITS;
+        int64_t slopeRise = ((int64_t)ratePerSampleCounts * (SlopeSamples - FastSamples))
+                            << GAS_RISE_FRACTION_BITS;
+        rate = slopeRise < INT32_MAX ? (int32_t)slopeRise : INT32_MAX;
+        sustain = sustainSamples;
+    }
+
+    // Feeds one frame (one sample per channel, in ADC counts).
+    void frameProcess(const uint16_t* frame)
+    {
+        if (!primed) {
+            for (int s = 0; s < Slots; s++) {
+                int32_t sample = (int32_t)frame[frameChannels[s]] << GAS_RISE_FRACTION_BITS;
+                fast[s] = sample;
+                slow[s] = sample;
+                baseline[s] = sample;
+            }
+            primed = true;
+        }
+
+        for (int s = 0; s < Slots; s++) {
+            int32_t sample = (int32_t)frame[frameChannels[s]] << GAS_RISE_FRACTION_BITS;
+            fast[s] += (sample - fast[s]) / FastSamples;
+            slow[s] += (sample - slow[s]) / SlopeSamples;
+
+            bool rising = fast[s] - slow[s] > rate;
+            sustained[s] = rising ? (uint8_t)(sustained[s] < UINT8_MAX ? sustained[s] + 1
+                                                                       : UINT8_MAX) : 0;
+            if (!rising) {
+                baseline[s] += (fast[s] - baseline[s]) / BaselineSamples;
+            }
+            if (fast[s] < baseline[s]) {
+                baseline[s] = fast[s];
+            }
+
+            int32_t risen = fast[s] - baseline[s];
+            if (tripped[s]) {
+                tripped[s] = fast[s] > clearLevel || risen > rise / 2;
+            } else {
+                tripped[s] = fast[s] > level || (sustained[s] >= sustain && risen > rise);
+            }
+        }
+    }
+
+    bool isTripped(int slot) const { return tripped[slot] != 0; }
+    int frameChannel(int slot) const { return frameChannels[slot]; }
+
+    bool anyTripped() const
+    {
+        uint8_t any = 0;
+        for (int s = 0; s < Slots; s++) {
+            any |= tripped[s];
+        }
+        return any != 0;
+    }
+
+private:
+    int32_t fast[Slots];
+    int32_t slow[Slots];
+    int32_t baseline[Slots];
+    uint16_t frameChannels[Slots];
+    uint8_t sustained[Slots];
+    uint8_t tripped[Slots];
+    bool primed;
+
+    int32_t level;
+    int32_t clearLevel;
+    int32_t rise;
+    int32_t rate;
+    uint8_t sustain;
+};
+
+//=====[#include guards - end]=================================================
+
+#endif // _GAS_RISE_DETECTOR_H_
@@ -0,0 +1,131 @@
+//=====[Libraries]=============================================================
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "FlashIAPBlockDevice.h"
+
+//=====[Declaration of private defines]========================================
+
+#define HOST_FLASH_DEFAULT_FILE    "simulator_flash.bin"
+#define HOST_FLASH_FILL_CHUNK      4096
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static bool fileErase(int fd, off_t from, off_t to);
+
+//=====[Implementations of public methods]=====================================
+
+FlashIAPBlockDevice::FlashIAPBlockDevice(uint32_t address, uint32_t size)
+    : flashAddress(address), flashSize(size), flash(NULL)
+{
+}
+
+int FlashIAPBlockDevice::init()
+{
+    const char* path = getenv("SIM_FLASH");
+    off_t offset = (off_t)flashAddress - HOST_FLASH_BASE_ADDRESS;
+    struct stat fileStatus;
+    bd_size_t erasedFrom = flashSize;
+    int fd;
+
+    if (flash != NULL) {
+        return 0;
+    }
+    if (path == NULL) {
+        path = HOST_FLASH_DEFAULT_FILE;
+    }
+    if (offset < 0 || offset % HOST_FLASH_ERASE_SIZE != 0) {
+        return -1;
+    }
+    fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0 || fstat(fd, &fileStatus) != 0) {
+        return -1;
+    }
+    // Flash beyond the end of the file has never been written: grow the
+    // file up to the end of this region, erased. The region itself is
+    // erased through the mapping, which also faults its pages in.
+    if (fileStatus.st_size < offset + (off_t)flashSize) {
+        erasedFrom = fileStatus.st_size > offset ? fileStatus.st_size - offset : 0;
+        if (!fileErase(fd, fileStatus.st_size, offset) ||
+            ftruncate(fd, offset + flashSize) != 0) {
+            close(fd);
+            return -1;
+        }
+    }
+    void* mapping = mmap(NULL, flashSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, offset);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return -1;
+    }
+    flash = (uint8_t*)mapping;
+    memset(flash + erasedFrom, 0xFF, flashSize - erasedFrom);
+    return 0;
+}
+
+int FlashIAPBlockDevice::deinit()
+{
+    if (flash != NULL) {
+        munmap(flash, flashSize);
+        flash = NULL;
+    }
+    return 0;
+}
+
+int FlashIAPBlockDevice::read(void* buffer, bd_addr_t addr, bd_size_t size)
+{
+    if (!isValid(addr, size)) {
+        return -1;
+    }
+    memcpy(buffer, flash + addr, size);
+    return 0;
+}
+
+int FlashIAPBlockDevice::program(const void* buffer, bd_addr_t addr, bd_size_t size)
+{
+    const uint8_t* bytes = (const uint8_t*)buffer;
+
+    if (!isValid(addr, size)) {
+        return -1;
+    }
+    for (bd_size_t i = 0; i < size; i++) {
+        flash[addr + i] &= bytes[i];
+    }
+    return 0;
+}
+
+int FlashIAPBlockDevice::erase(bd_addr_t addr, bd_size_t size)
+{
+    if (!isValid(addr, size) || addr % HOST_FLASH_ERASE_SIZE != 0 ||
+        size % HOST_FLASH_ERASE_SIZE != 0) {
+        return -1;
+    }
+    memset(flash + addr, 0xFF, size);
+    return 0;
+}
+
+//=====[Implementations of private methods]====================================
+
+bool FlashIAPBlockDevice::isValid(bd_addr_t addr, bd_size_t size) const
+{
+    return flash != NULL && addr + size <= flashSize;
+}
+
+//=====[Implementations of private functions]==================================
+
+static bool fileErase(int fd, off_t from, off_t to)
+{
+    uint8_t erased[HOST_FLASH_FILL_CHUNK];
+
+    memset(erased, 0xFF, sizeof(erased));
+    while (from < to) {
+        size_t length = to - from < (off_t)sizeof(erased) ? (size_t)(to - from) : sizeof(erased);
+        if (pwrite(fd, erased, length, from) != (ssize_t)length) {
+            return false;
+        }
+        from += length;
+    }
+    return true;
+}
@@ -0,0 +1,57 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _HOST_FLASHIAP_BLOCK_DEVICE_H_
+#define _HOST_FLASHIAP_BLOCK_DEVICE_H_
+
+// Host stand-in for mbed-os FlashIAPBlockDevice. The file SIM_FLASH (default
+// simulator_flash.bin) is the board's flash from HOST_FLASH_BASE_ADDRESS on,
+// and each device memory-maps its own region of it, so contents survive
+// between simulator runs, like flash survives a reset. Program and erase
+// follow NOR flash rules: erase sets bytes to 0xFF, program can only clear
+// bits.
+
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+
+//=====[Declaration of public defines]=========================================
+
+#define HOST_FLASH_BASE_ADDRESS    0x08000000
+#define HOST_FLASH_ERASE_SIZE      (128 * 1024)
+#define HOST_FLASH_PROGRAM_SIZE    1
+
+//=====[Declaration of public data types]======================================
+
+typedef uint64_t bd_addr_t;
+typedef uint64_t bd_size_t;
+
+//=====[Declaration of public classes]=========================================
+
+class FlashIAPBlockDevice {
+public:
+    FlashIAPBlockDevice(uint32_t address, uint32_t size);
+
+    int init();
+    int deinit();
+    int read(void* buffer, bd_addr_t addr, bd_size_t size);
+    int program(const void* buffer, bd_addr_t addr, bd_size_t size);
+    int erase(bd_addr_t addr, bd_size_t size);
+
+    bd_size_t get_read_size() const { return 1; }
+    bd_size_t get_program_size() const { return HOST_FLASH_PROGRAM_SIZE; }
+    bd_size_t get_erase_size() const { return HOST_FLASH_ERASE_SIZE; }
+    bd_size_t get_erase_size(bd_addr_t addr) const { (void)addr; return HOST_FLASH_ERASE_SIZE; }
+    int get_erase_value() const { return 0xFF; }
+    bd_size_t size() const { return flashSize; }
+
+private:
+    bool isValid(bd_addr_t addr, bd_size_t size) const;
+
+    uint32_t flashAddress;
+    uint32_t flashSize;
+    uint8_t* flash;
+};
+
+//=====[#include guards - end]=================================================
+
+#endif // _HOST_FLASHIAP_BLOCK_DEVICE_H_
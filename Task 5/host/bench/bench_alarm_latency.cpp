@@ -0,0 +1,352 @@
+//=====[Host benchmark: end-to-end alarm latency]==============================
+//
+// Replays generated MQ2 traces through the simulator (SIM_LATENCY=1) and
+// measures, from the moment the input crosses gasDetectionThreshold, how long
+// the firmware takes to drive the siren, to toggle the alarm LED and to log
+// EVENT_GAS_DET_ON. Scenarios:
+//
+//   step         clean air to gas in one sample, at 20 phases of the block grid
+//   ramp         slow, medium and fast linear rises, 4 phases each
+//   noisy        uniform noise around a low then a high level, 10 seeds
+//   throughput   gas and temperature toggling every second for 30 s: events
+//                logged per simulated second, events dropped and host CPU cost
+//
+// Latencies are in simulated time, so they are exact and any increase above
+// 1 ms is a regression. CPU costs are host time and only fail beyond 1.5x
+// the baseline; regenerate the baseline on a new machine with --update.
+// Build from the "Task 5" directory and run with the simulator:
+//
+//   g++ -O2 -std=c++14 host/bench/bench_alarm_latency.cpp -o bench_alarm_latency
+//   ./bench_alarm_latency ./simulator host/bench/alarm_latency.baseline [--update]
+//
+// Exits with 1 if any metric regressed against the baseline.
+//
+//=============================================================================
+
+//=====[Libraries]=============================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+
+//=====[Declaration of private defines]========================================
+
+#define BENCH_THRESHOLD               0.4     // DefaultAlarmConfig::gasDetectionThreshold
+#define BENCH_MAX_RUNS               32
+#define BENCH_MAX_METRICS            64
+#define BENCH_NAME_LENGTH            48
+#define BENCH_NEVER_MS          1000000.0
+#define BENCH_LATENCY_SLACK_MS        1.0
+#define BENCH_CPU_FACTOR              1.5
+#define BENCH_CPU_SLACK_NS          200.0
+#define BENCH_BASELINE_ROUNDING       0.0005  // baseline values are written with %.3f
+
+//=====[Declaration of private data types]=====================================
+
+typedef enum {
+    BENCH_LOWER_IS_BETTER,
+    BENCH_CPU,
+    BENCH_HIGHER_IS_BETTER
+} benchKind_t;
+
+typedef struct benchMetric {
+    char name[BENCH_NAME_LENGTH];
+    double value;
+    benchKind_t kind;
+} benchMetric_t;
+
+// The simulator's "latency" line
+typedef struct benchRun {
+    double sirenMs;
+    double ledMs;
+    double eventMs;
+    unsigned long events;
+    unsigned long dropped;
+    unsigned long alarmPassNs;
+    unsigned long eventNs;
+} benchRun_t;
+
+//=====[Declaration and initialization of private global variables]============
+
+static const char* simulatorPath;
+static char tracePath[64];
+static char flashPath[64];
+
+static benchMetric_t metrics[BENCH_MAX_METRICS];
+static int numberOfMetrics = 0;
+
+//=====[Implementations of private functions]==================================
+
+static void metricAdd(const char* scenario, const char* name, double value, benchKind_t kind)
+{
+    benchMetric_t* metric = &metrics[numberOfMetrics++];
+
+    snprintf(metric->name, sizeof(metric->name), "%s.%s", scenario, name);
+    metric->value = value;
+    metric->kind = kind;
+}
+
+static FILE* traceBegin()
+{
+    FILE* trace = fopen(tracePath, "w");
+    if (trace == NULL) {
+        perror(tracePath);
+        exit(2);
+    }
+    fprintf(trace, "0 lm35 0.07\n0 mq2 0.10\n");
+    return trace;
+}
+
+static benchRun_t simulatorRun(FILE* trace, unsigned long endMs)
+{
+    char command[512];
+    char line[256];
+    benchRun_t run;
+    bool found = false;
+
+    fprintf(trace, "%lu end\n", endMs);
+    fclose(trace);
+    remove(flashPath);
+
+    snprintf(command, sizeof(command),
+             "SIM_QUIET=1 SIM_LATENCY=1 SIM_FLASH=%s SIM_TRACE=%s '%s' 2>&1 >/dev/null",
+             flashPath, tracePath, simulatorPath);
+    FILE* output = popen(command, "r");
+    if (output == NULL) {
+        perror("popen");
+        exit(2);
+    }
+    while (fgets(line, sizeof(line), output) != NULL) {
+        if (sscanf(line, "latency siren_ms=%lf led_ms=%lf event_ms=%lf events=%lu dropped=%lu "
+                   "alarm_pass_ns=%lu event_ns=%lu", &run.sirenMs, &run.ledMs, &run.eventMs,
+                   &run.events, &run.dropped, &run.alarmPassNs, &run.eventNs) == 7) {
+            found = true;
+        }
+    }
+    if (pclose(output) != 0 || !found) {
+        fprintf(stderr, "%s failed or printed no latency line\n", simulatorPath);
+        exit(2);
+    }
+    return run;
+}
+
+// Time from the threshold crossing to a mark, or BENCH_NEVER_MS
+static double latencyMs(double markMs, double crossingMs)
+{
+    return markMs < 0 ? BENCH_NEVER_MS : markMs - crossingMs;
+}
+
+static double percentile(double* values, int count, int percent)
+{
+    std::sort(values, values + count);
+    return values[(count - 1) * percent / 100];
+}
+
+static void latencyReport(const char* scenario, const char* mark, double* latencies, int count)
+{
+    char name[BENCH_NAME_LENGTH];
+
+    printf("%-12s %-7s %9.3f %9.3f %9.3f %9.3f\n", scenario, mark,
+           percentile(latencies, count, 0), percentile(latencies, count, 50),
+           percentile(latencies, count, 90), percentile(latencies, count, 100));
+    snprintf(name, sizeof(name), "%s_p50_ms", mark);
+    metricAdd(scenario, name, percentile(latencies, count, 50), BENCH_LOWER_IS_BETTER);
+    snprintf(name, sizeof(name), "%s_max_ms", mark);
+    metricAdd(scenario, name, percentile(latencies, count, 100), BENCH_LOWER_IS_BETTER);
+}
+
+static void scenarioReport(const char* scenario, const benchRun_t* runs,
+                           const double* crossingsMs, int count)
+{
+    double siren[BENCH_MAX_RUNS];
+    double led[BENCH_MAX_RUNS];
+    double event[BENCH_MAX_RUNS];
+
+    for (int i = 0; i < count; i++) {
+        siren[i] = latencyMs(runs[i].sirenMs, crossingsMs[i]);
+        led[i] = latencyMs(runs[i].ledMs, crossingsMs[i]);
+        event[i] = latencyMs(runs[i].eventMs, crossingsMs[i]);
+    }
+    latencyReport(scenario, "siren", siren, count);
+    latencyReport(scenario, "led", led, count);
+    latencyReport(scenario, "event", event, count);
+}
+
+static void stepScenario()
+{
+    benchRun_t runs[20];
+    double crossingsMs[20];
+
+    for (int i = 0; i < 20; i++) {
+        FILE* trace = traceBegin();
+        crossingsMs[i] = 3000 + 7 * i;
+        fprintf(trace, "%.0f mq2 0.80\n", crossingsMs[i]);
+        runs[i] = simulatorRun(trace, 6000 + 7 * i);
+    }
+    scenarioReport("step", runs, crossingsMs, 20);
+}
+
+// From 0.10 to 0.90 at slopePerS, one point every 5 ms
+static void rampScenario(const char* scenario, double slopePerS)
+{
+    benchRun_t runs[4];
+    double crossingsMs[4];
+
+    for (int i = 0; i < 4; i++) {
+        FILE* trace = traceBegin();
+        unsigned long startMs = 3000 + 13 * i;
+        unsigned long timeMs = startMs;
+        double level = 0.10;
+
+        crossingsMs[i] = -1;
+        while (level < 0.90) {
+            timeMs += 5;
+            level = 0.10 + slopePerS * (timeMs - startMs) / 1000.0;
+            fprintf(trace, "%lu mq2 %.4f\n", timeMs, std::min(level, 0.90));
+            if (crossingsMs[i] < 0 && level >= BENCH_THRESHOLD) {
+                crossingsMs[i] = timeMs;
+            }
+        }
+        runs[i] = simulatorRun(trace, timeMs + 3000);
+    }
+    scenarioReport(scenario, runs, crossingsMs, 4);
+}
+
+// Noise of +-0.1 every 5 ms around 0.15, then around 0.65 from 3000 ms on;
+// neither band reaches the threshold from the wrong side.
+static void noisyScenario()
+{
+    benchRun_t runs[10];
+    double crossingsMs[10];
+
+    for (int seed = 0; seed < 10; seed++) {
+        FILE* trace = traceBegin();
+        srand(seed + 1);
+        crossingsMs[seed] = 3000 + 11 * seed;
+        for (unsigned long timeMs = 5; timeMs < crossingsMs[seed] + 3000; timeMs += 5) {
+            double mean = timeMs < crossingsMs[seed] ? 0.15 : 0.65;
+            fprintf(trace, "%lu mq2 %.4f\n", timeMs, mean + 0.2 * rand() / RAND_MAX - 0.1);
+        }
+        runs[seed] = simulatorRun(trace, (unsigned long)crossingsMs[seed] + 3000);
+    }
+    scenarioReport("noisy", runs, crossingsMs, 10);
+}
+
+static void throughputScenario()
+{
+    FILE* trace = traceBegin();
+    const unsigned long endMs = 30000;
+
+    // Each level is held long enough for the filters to cross the thresholds
+    for (unsigned long timeMs = 1000; timeMs < endMs; timeMs += 1000) {
+        bool on = (timeMs / 1000) % 2 == 1;
+        fprintf(trace, "%lu mq2 %s\n", timeMs, on ? "0.80" : "0.10");
+        fprintf(trace, "%lu lm35 %s\n", timeMs + 500, on ? "0.20" : "0.07");
+    }
+    benchRun_t run = simulatorRun(trace, endMs);
+
+    printf("\nthroughput   %.2f events/s, %lu dropped, %lu ns per alarm pass, "
+           "%lu ns per event logged\n",
+           run.events * 1000.0 / endMs, run.dropped, run.alarmPassNs, run.eventNs);
+    metricAdd("throughput", "events_per_s", run.events * 1000.0 / endMs,
+              BENCH_HIGHER_IS_BETTER);
+    metricAdd("throughput", "dropped", run.dropped, BENCH_LOWER_IS_BETTER);
+    // Zero when the simulator was built with the profiler compiled out
+    if (run.alarmPassNs > 0) {
+        metricAdd("throughput", "alarm_pass_ns", run.alarmPassNs, BENCH_CPU);
+        metricAdd("throughput", "event_ns", run.eventNs, BENCH_CPU);
+    }
+}
+
+static bool metricRegressed(const benchMetric_t* metric, double baseline)
+{
+    switch (metric->kind) {
+    case BENCH_LOWER_IS_BETTER:
+        return metric->value > baseline + BENCH_LATENCY_SLACK_MS;
+    case BENCH_CPU:
+        return metric->value > baseline * BENCH_CPU_FACTOR + BENCH_CPU_SLACK_NS;
+    case BENCH_HIGHER_IS_BETTER:
+        return metric->value + BENCH_BASELINE_ROUNDING < baseline;
+    }
+    return false;
+}
+
+// Baseline lines are "<metric> <value>"; metrics missing from either side
+// are reported but never fail.
+static int baselineCompare(const char* baselinePath)
+{
+    FILE* baseline = fopen(baselinePath, "r");
+    char name[BENCH_NAME_LENGTH];
+    double value;
+    int regressions = 0;
+
+    if (baseline == NULL) {
+        fprintf(stderr, "%s: no baseline, run with --update to create one\n", baselinePath);
+        return 1;
+    }
+    printf("\n");
+    while (fscanf(baseline, "%47s %lf", name, &value) == 2) {
+        int i = 0;
+        while (i < numberOfMetrics && strcmp(metrics[i].name, name) != 0) {
+            i++;
+        }
+        if (i == numberOfMetrics) {
+            printf("%-28s not measured\n", name);
+        } else if (metricRegressed(&metrics[i], value)) {
+            printf("%-28s REGRESSED %.3f -> %.3f\n", name, value, metrics[i].value);
+            regressions++;
+        }
+    }
+    fclose(baseline);
+    printf("%d regression%s against %s\n", regressions, regressions == 1 ? "" : "s",
+           baselinePath);
+    return regressions > 0 ? 1 : 0;
+}
+
+static int baselineWrite(const char* baselinePath)
+{
+    FILE* baseline = fopen(baselinePath, "w");
+
+    if (baseline == NULL) {
+        perror(baselinePath);
+        return 2;
+    }
+    for (int i = 0; i < numberOfMetrics; i++) {
+        fprintf(baseline, "%s %.3f\n", metrics[i].name, metrics[i].value);
+    }
+    fclose(baseline);
+    printf("\nbaseline written to %s\n", baselinePath);
+    return 0;
+}
+
+//=====[Main function]=========================================================
+
+int main(int argc, char** argv)
+{
+    if (argc < 3 || (argc == 4 && strcmp(argv[3], "--update") != 0) || argc > 4) {
+        fprintf(stderr, "usage: %s <simulator> <baseline> [--update]\n", argv[0]);
+        return 2;
+    }
+    simulatorPath = argv[1];
+    snprintf(tracePath, sizeof(tracePath), "/tmp/bench_alarm_latency.%d.trace", (int)getpid());
+    snprintf(flashPath, sizeof(flashPath), "/tmp/bench_alarm_latency.%d.flash", (int)getpid());
+
+    printf("latency from threshold crossing, simulated ms\n");
+    printf("%-12s %-7s %9s %9s %9s %9s\n", "scenario", "mark", "min", "p50", "p90", "max");
+    stepScenario();
+    rampScenario("ramp_slow", 0.2);
+    rampScenario("ramp_medium", 1.0);
+    rampScenario("ramp_fast", 5.0);
+    noisyScenario();
+    throughputScenario();
+
+    remove(tracePath);
+    remove(flashPath);
+
+    if (argc == 4) {
+        return baselineWrite(argv[2]);
+    }
+    return baselineCompare(argv[2]);
+}
@@ -0,0 +1,99 @@
+//=====[Host benchmark: multi-zone alarm]======================================
+//
+// Per-tick cost of AlarmSystem for 1 to 512 zones, each zone with one LM35
+// and one MQ2 channel. A tick is one sensor block (SENSOR_BLOCK_SIZE frames)
+// followed by detectorsUpdate() and transitionsUpdate(), as the firmware
+// runs them every SENSOR_BLOCK_PERIOD_MS. A third of the zones see gas, so
+// the zone state machines take both branches.
+//
+//   g++ -O3 -std=c++14 -I../.. bench_alarm_zones.cpp -o bench_alarm_zones
+//
+//=============================================================================
+
+//=====[Libraries]=============================================================
+
+#include <stdio.h>
+#include <chrono>
+
+#include "alarm_system.h"
+
+//=====[Declaration of private defines]========================================
+
+#define BENCH_TICKS           20000
+#define BENCH_BLOCK_SIZE          5
+
+//=====[Declaration of private data types]=====================================
+
+template <int Zones>
+struct BenchZoneConfig : DefaultAlarmConfig {
+    static constexpr int sensorChannels = 2 * Zones;
+    static constexpr sensorKind_t sensorKind(int channel)
+    {
+        return channel % 2 == 0 ? SENSOR_KIND_TEMPERATURE : SENSOR_KIND_GAS;
+    }
+    static constexpr int zones = Zones;
+    static constexpr int sensorZone(int channel) { return channel / 2; }
+};
+
+//=====[Declaration and initialization of private global variables]============
+
+static volatile int benchSink = 0;
+
+//=====[Implementations of private functions]==================================
+
+static uint16_t sampleAt(int tick, int channel)
+{
+    int zone = channel / 2;
+    if (channel % 2 == 0) {
+        return 4000 + (tick * 7 + zone) % 500;                 // about 20 °C
+    }
+    if (zone % 3 == 0 && (tick / 200 + zone) % 2 == 0) {
+        return 40000 + (tick * 13 + zone) % 4000;              // gas present
+    }
+    return 8000 + (tick * 13 + zone) % 4000;
+}
+
+template <int Zones>
+static void benchZones()
+{
+    typedef BenchZoneConfig<Zones> config_t;
+    static AlarmSystem<config_t> alarmSystem;
+    static uint16_t frames[64][BENCH_BLOCK_SIZE][config_t::sensorChannels];
+    int checksum = 0;
+
+    for (int set = 0; set < 64; set++) {
+        for (int i = 0; i < BENCH_BLOCK_SIZE; i++) {
+            for (int c = 0; c < config_t::sensorChannels; c++) {
+                frames[set][i][c] = sampleAt(set * 50 + i, c);
+            }
+        }
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < BENCH_TICKS; tick++) {
+        alarmSystem.framesProcess(frames[(tick / 4) % 64]);
+        checksum += alarmSystem.detectorsUpdate(false);
+        checksum += alarmSystem.transitionsUpdate();
+        if (tick % 97 == 0) {
+            alarmSystem.codeEnter("1805");
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    double tickNs = elapsed.count() / BENCH_TICKS;
+    benchSink = checksum;
+
+    printf("%4d zones  %9.1f ns/tick  %6.2f ns/zone\n", Zones, tickNs, tickNs / Zones);
+}
+
+//=====[Main function]=========================================================
+
+int main()
+{
+    benchZones<1>();
+    benchZones<8>();
+    benchZones<32>();
+    benchZones<128>();
+    benchZones<256>();
+    benchZones<512>();
+    return 0;
+}
@@ -0,0 +1,127 @@
+//=====[Host benchmark: integer sensor pipeline]===============================
+//
+// Compares the original float/double sensor path (AnalogIn::read() floats,
+// a float moving average and the "* 3.3 / 0.01" and "* 9.0 / 5.0 + 32.0"
+// double formulas) against the integer path in sensor_scaling.h, for speed
+// and for accuracy over every possible ADC count.
+//
+//   g++ -O2 -std=c++14 -I../.. bench_integer_pipeline.cpp -o bench_integer_pipeline
+//
+// On the host both paths run on a hardware FPU with double support, so the
+// speed-up here understates the one on a single-precision Cortex-M4F.
+//
+//=============================================================================
+
+//=====[Libraries]=============================================================
+
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+
+#include "sensor_filter.h"
+#include "sensor_scaling.h"
+
+//=====[Declaration of private defines]========================================
+
+#define BENCH_SAMPLES             1000000
+#define NUMBER_OF_AVG_SAMPLES     100
+#define OVER_TEMP_LEVEL           25
+#define GAS_DETECTION_THRESHOLD   0.4
+
+//=====[Declaration and initialization of private global variables]============
+
+static volatile int benchSink = 0;
+
+//=====[Implementations of private functions]==================================
+
+static uint16_t sampleAt(int i)
+{
+    return (uint16_t)((i * 7919u) % 12000u);
+}
+
+static float analogReadingScaledWithTheLM35Formula(float analogReading)
+{
+    return (analogReading * 3.3 / 0.01);
+}
+
+static float celsiusToFahrenheit(float tempInCelsiusDegrees)
+{
+    return (tempInCelsiusDegrees * 9.0 / 5.0 + 32.0);
+}
+
+static double nanosecondsPerSample(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / BENCH_SAMPLES;
+}
+
+static void benchSpeed()
+{
+    static MovingAverageFilter<float, NUMBER_OF_AVG_SAMPLES> floatFilter;
+    static MovingAverageFilter<uint16_t, NUMBER_OF_AVG_SAMPLES, uint32_t> integerFilter;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        float average = floatFilter.update(sampleAt(i) / 65535.0f);
+        float tempC = analogReadingScaledWithTheLM35Formula(average);
+        benchSink = (tempC > OVER_TEMP_LEVEL) + (int)celsiusToFahrenheit(tempC);
+    }
+    double floatNs = nanosecondsPerSample(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCH_SAMPLES; i++) {
+        uint16_t average = integerFilter.update(sampleAt(i));
+        int32_t centiC = lm35CountsToCentiCelsius(average);
+        benchSink = (average > lm35CountsAtCelsius(OVER_TEMP_LEVEL)) +
+                    centiCelsiusToCentiFahrenheit(centiC);
+    }
+    double integerNs = nanosecondsPerSample(start);
+
+    printf("float path    %6.2f ns/sample\n", floatNs);
+    printf("integer path  %6.2f ns/sample (%.1fx)\n", integerNs, floatNs / integerNs);
+}
+
+static void benchAccuracy()
+{
+    double maxCelsiusError = 0.0;
+    double maxFahrenheitError = 0.0;
+    int overTempMismatches = 0;
+    int gasMismatches = 0;
+
+    for (uint32_t counts = 0; counts <= ADC_FULL_SCALE_COUNTS; counts++) {
+        float reading = counts / 65535.0f;
+        float tempC = analogReadingScaledWithTheLM35Formula(reading);
+        int32_t centiC = lm35CountsToCentiCelsius((uint16_t)counts);
+
+        double celsiusError = fabs(centiC / 100.0 - tempC);
+        double fahrenheitError =
+            fabs(centiCelsiusToCentiFahrenheit(centiC) / 100.0 - celsiusToFahrenheit(tempC));
+        if (celsiusError > maxCelsiusError) {
+            maxCelsiusError = celsiusError;
+        }
+        if (fahrenheitError > maxFahrenheitError) {
+            maxFahrenheitError = fahrenheitError;
+        }
+        if ((tempC > OVER_TEMP_LEVEL) != (counts > lm35CountsAtCelsius(OVER_TEMP_LEVEL))) {
+            overTempMismatches++;
+        }
+        if ((reading > GAS_DETECTION_THRESHOLD) !=
+            (counts > adcCountsAtFraction(GAS_DETECTION_THRESHOLD))) {
+            gasMismatches++;
+        }
+    }
+
+    printf("max |error| vs float path: %.4f C, %.4f F\n", maxCelsiusError, maxFahrenheitError);
+    printf("threshold decisions differing over all 65536 counts: over-temp %d, gas %d\n",
+           overTempMismatches, gasMismatches);
+}
+
+//=====[Main function]=========================================================
+
+int main()
+{
+    benchSpeed();
+    benchAccuracy();
+    return 0;
+}
@@ -0,0 +1,115 @@
+//=====[Host benchmark: sensor bank]===========================================
+//
+// Cost of one sensor block (SENSOR_BLOCK_SIZE frames plus threshold
+// evaluation) for 2 to 64 channels, comparing one MovingAverageFilter and
+// one threshold compare per channel, as the firmware had for the LM35 and
+// MQ2, against the structure-of-arrays SensorBank.
+//
+//   g++ -O3 -std=c++14 -I../.. bench_sensor_bank.cpp -o bench_sensor_bank
+//
+// -O3 because the -O2 cost model of GCC 12 declines to vectorize the
+// widening uint16 to uint32 add in SensorBank::frameProcess().
+//
+//=============================================================================
+
+//=====[Libraries]=============================================================
+
+#include <stdio.h>
+#include <chrono>
+
+#include "sensor_bank.h"
+#include "sensor_filter.h"
+
+//=====[Declaration of private defines]========================================
+
+#define BENCH_BLOCKS          20000
+#define BENCH_BLOCK_SIZE          5
+#define BENCH_WINDOW            100
+#define BENCH_THRESHOLD       26214
+
+//=====[Declaration and initialization of private global variables]============
+
+static volatile int benchSink = 0;
+
+//=====[Implementations of private functions]==================================
+
+static uint16_t sampleAt(int frame, int channel)
+{
+    return (uint16_t)(((frame + 1) * 7919u + channel * 104729u) % 40000u);
+}
+
+static double nanosecondsPerBlock(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / BENCH_BLOCKS;
+}
+
+template <int Channels>
+static void benchChannels()
+{
+    static uint16_t frames[BENCH_BLOCKS % 64 + 64][BENCH_BLOCK_SIZE][Channels];
+    static MovingAverageFilter<uint16_t, BENCH_WINDOW, uint32_t> filters[Channels];
+    static bool filterStates[Channels];
+    static SensorBank<Channels, BENCH_WINDOW> bank;
+    const int frameSets = sizeof(frames) / sizeof(frames[0]);
+    int rising = 0;
+
+    for (int set = 0; set < frameSets; set++) {
+        for (int i = 0; i < BENCH_BLOCK_SIZE; i++) {
+            for (int c = 0; c < Channels; c++) {
+                frames[set][i][c] = sampleAt(set * BENCH_BLOCK_SIZE + i, c);
+            }
+        }
+    }
+    for (int c = 0; c < Channels; c++) {
+        bank.channelSet(c, c % 2 ? SENSOR_KIND_GAS : SENSOR_KIND_TEMPERATURE, BENCH_THRESHOLD);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int block = 0; block < BENCH_BLOCKS; block++) {
+        uint16_t (&blockFrames)[BENCH_BLOCK_SIZE][Channels] = frames[block % frameSets];
+        for (int c = 0; c < Channels; c++) {
+            uint16_t average = 0;
+            for (int i = 0; i < BENCH_BLOCK_SIZE; i++) {
+                average = filters[c].update(blockFrames[i][c]);
+            }
+            bool state = average > BENCH_THRESHOLD;
+            if (state && !filterStates[c]) {
+                rising++;
+            }
+            filterStates[c] = state;
+        }
+    }
+    double filtersNs = nanosecondsPerBlock(start);
+    benchSink = rising;
+
+    rising = 0;
+    start = std::chrono::steady_clock::now();
+    for (int block = 0; block < BENCH_BLOCKS; block++) {
+        uint16_t (&blockFrames)[BENCH_BLOCK_SIZE][Channels] = frames[block % frameSets];
+        for (int i = 0; i < BENCH_BLOCK_SIZE; i++) {
+            bank.frameProcess(blockFrames[i]);
+        }
+        if (bank.evaluate()) {
+            bank.risingEdgesForEach([&rising](int) { rising++; });
+        }
+    }
+    double bankNs = nanosecondsPerBlock(start);
+    benchSink += rising;
+
+    printf("%3d channels  per-channel filters %8.1f ns/block   bank %7.1f ns/block"
+           "   (%.1fx, %.2f ns/channel)\n",
+           Channels, filtersNs, bankNs, filtersNs / bankNs, bankNs / Channels);
+}
+
+//=====[Main function]=========================================================
+
+int main()
+{
+    benchChannels<2>();
+    benchChannels<16>();
+    benchChannels<32>();
+    benchChannels<64>();
+    return 0;
+}
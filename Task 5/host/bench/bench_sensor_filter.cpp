@@ -0,0 +1,124 @@
+//=====[Host benchmark: sensor filters]========================================
+//
+// Compares the original per-tick rescan of the averaging window against the
+// incremental filters in sensor_filter.h at several window sizes, and a
+// per-tick sort of a spike-rejection window against MedianFilter.
+//
+//   g++ -O2 -std=c++14 -I../.. bench_sensor_filter.cpp -o bench_sensor_filter
+//
+//=============================================================================
+
+//=====[Libraries]=============================================================
+
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+
+#include "sensor_filter.h"
+
+//=====[Declaration of private defines]========================================
+
+#define BENCH_TICKS    200000
+
+//=====[Declaration and initialization of private global variables]============
+
+static volatile float benchSink = 0.0;
+
+//=====[Implementations of private functions]==================================
+
+static float sampleAt(int tick)
+{
+    return (float)((tick * 7919) % 1000) / 1000.0f;
+}
+
+static double nanosecondsPerTick(std::chrono::steady_clock::time_point start)
+{
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    return elapsed.count() / BENCH_TICKS;
+}
+
+template <int N>
+static void benchWindow()
+{
+    static float readingsArray[N];
+    static MovingAverageFilter<float, N> movingAverage;
+    static EmaFilter<float, N> ema;
+    int sampleIndex = 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < BENCH_TICKS; tick++) {
+        readingsArray[sampleIndex] = sampleAt(tick);
+        sampleIndex++;
+        if (sampleIndex >= N) {
+            sampleIndex = 0;
+        }
+        float readingsSum = 0.0;
+        for (int i = 0; i < N; i++) {
+            readingsSum += readingsArray[i];
+        }
+        benchSink = readingsSum / N;
+    }
+    double rescanNs = nanosecondsPerTick(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < BENCH_TICKS; tick++) {
+        benchSink = movingAverage.update(sampleAt(tick));
+    }
+    double movingAverageNs = nanosecondsPerTick(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < BENCH_TICKS; tick++) {
+        benchSink = ema.update(sampleAt(tick));
+    }
+    double emaNs = nanosecondsPerTick(start);
+
+    printf("%6d  %12.1f  %16.1f  %9.1f  %7.1fx\n",
+           N, rescanNs, movingAverageNs, emaNs, rescanNs / movingAverageNs);
+}
+
+template <int N>
+static void benchMedianWindow()
+{
+    static float readingsArray[N];
+    static float sortedArray[N];
+    static MedianFilter<float, N> median;
+    int sampleIndex = 0;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < BENCH_TICKS; tick++) {
+        readingsArray[sampleIndex] = sampleAt(tick);
+        sampleIndex++;
+        if (sampleIndex >= N) {
+            sampleIndex = 0;
+        }
+        std::copy(readingsArray, readingsArray + N, sortedArray);
+        std::sort(sortedArray, sortedArray + N);
+        benchSink = sortedArray[N / 2];
+    }
+    double sortNs = nanosecondsPerTick(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int tick = 0; tick < BENCH_TICKS; tick++) {
+        benchSink = median.update(sampleAt(tick));
+    }
+    double medianNs = nanosecondsPerTick(start);
+
+    printf("%6d  %10.1f  %12.1f  %7.1fx\n", N, sortNs, medianNs, sortNs / medianNs);
+}
+
+//=====[Main function]=========================================================
+
+int main()
+{
+    printf("window  rescan ns/tk  moving avg ns/tk  ema ns/tk  speedup\n");
+    benchWindow<100>();
+    benchWindow<1000>();
+    benchWindow<10000>();
+
+    printf("\nwindow  sort ns/tk  median ns/tk  speedup\n");
+    benchMedianWindow<5>();
+    benchMedianWindow<9>();
+    benchMedianWindow<31>();
+    return 0;
+}
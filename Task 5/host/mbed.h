@@ -0,0 +1,330 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _HOST_MBED_H_
+#define _HOST_MBED_H_
+
+// Host stand-in for the subset of mbed-os used by the firmware. The
+// peripherals below are backed by a pin table and a virtual clock in
+// mbed_host.cpp, so main.cpp builds for Linux without modification and runs
+// in simulated time. See simulator.cpp for the build line and trace format.
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <chrono>
+
+//=====[Declaration of public defines]=========================================
+
+#define MBED_HOST_BUILD    1
+
+//=====[Declaration of public data types]======================================
+
+typedef enum {
+    PA_15, PB_3, PB_5, PB_12, PB_13, PB_15, PC_6, PC_7, PC_13, PE_10,
+    PA_3, PB_0, PB_7, PB_14, PC_0, PC_3, PD_8, PD_9,
+    HOST_PIN_COUNT,
+    NC = -1
+} PinName;
+
+#define A1        PC_0
+#define A3        PA_3
+#define LED1      PB_0
+#define LED2      PB_7
+#define LED3      PB_14
+#define BUTTON1   PC_13
+#define USBTX     PD_8
+#define USBRX     PD_9
+
+typedef enum {
+    osPriorityIdle = 1,
+    osPriorityLow = 8,
+    osPriorityBelowNormal = 16,
+    osPriorityNormal = 24,
+    osPriorityAboveNormal = 32,
+    osPriorityHigh = 40,
+    osPriorityRealtime = 48
+} osPriority;
+
+typedef int32_t osStatus;
+
+#define osOK             0
+#define osError         -1
+#define OS_STACK_SIZE    4096
+
+typedef enum {
+    PullNone,
+    PullUp,
+    PullDown,
+    OpenDrain
+} PinMode;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+// Virtual clock, in microseconds since power-up.
+uint64_t hostClockUs();
+void hostClockAdvanceUs(uint64_t us);
+uint64_t hostNextEventUs();
+bool hostInInterrupt();
+void hostIdle();
+void hostCountSleep();
+
+int hostPinRead(PinName pin);
+void hostPinWrite(PinName pin, int level);
+void hostPinSetMode(PinName pin, PinMode mode);
+void hostPinSetOutput(PinName pin, bool isOutput);
+float hostAnalogRead(PinName pin);
+
+bool hostUartReadable();
+bool hostUartWritable();
+int hostUartGetc();
+void hostUartPut(const void* buffer, size_t size);
+void hostUartAttach(int irqType, void (*func)());
+
+class InterruptIn;
+class Ticker;
+void hostInterruptInRegister(InterruptIn* interruptIn);
+void hostTimeoutSchedule(Ticker* timeout, uint64_t expiryUs);
+void hostTimeoutCancel(Ticker* timeout);
+
+uint32_t us_ticker_read();
+
+void core_util_critical_section_enter();
+void core_util_critical_section_exit();
+
+void thread_sleep_for(uint32_t millisec);
+void wait_us(int us);
+void set_time(time_t t);
+
+//=====[Declaration of public classes]=========================================
+
+namespace Kernel {
+struct Clock {
+    typedef std::chrono::milliseconds duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<Clock> time_point;
+    static const bool is_steady = true;
+    static time_point now();
+};
+}
+
+// Threads run on std::thread, but only one at a time, as on a single-core
+// RTOS: the highest-priority ready thread runs until it blocks in a sleep,
+// a flags wait or a join. While every thread is blocked the virtual clock
+// moves to the next timer or UART event, whose interrupt may wake one. Code
+// between blocking calls takes no simulated time. See rtos_host.cpp.
+class Thread {
+public:
+    Thread(osPriority priority = osPriorityNormal, uint32_t stack_size = OS_STACK_SIZE,
+           unsigned char* stack_mem = NULL, const char* name = NULL);
+    Thread(const Thread&) = delete;
+    Thread& operator=(const Thread&) = delete;
+
+    osStatus start(void (*task)());
+    osStatus join();
+    uint32_t flags_set(uint32_t flags);
+    osPriority get_priority() const { return priority; }
+    const char* get_name() const { return name; }
+    uint32_t stack_size() const { return stackSize; }
+    uint32_t max_stack() const { return 0; }     // host threads keep no watermark
+
+private:
+    osPriority priority;
+    uint32_t stackSize;
+    const char* name;
+    int id;
+};
+
+namespace ThisThread {
+void sleep_for(Kernel::Clock::duration rel_time);
+void sleep_until(Kernel::Clock::time_point abs_time);
+uint32_t flags_wait_any(uint32_t flags, bool clear = true);
+uint32_t flags_wait_any_until(uint32_t flags, Kernel::Clock::time_point abs_time,
+                              bool clear = true);
+}
+
+class AnalogIn {
+public:
+    AnalogIn(PinName pin) : pin(pin) {}
+    float read() { return hostAnalogRead(pin); }
+    unsigned short read_u16() { return (unsigned short)(read() * 65535.0f); }
+    operator float() { return read(); }
+
+private:
+    PinName pin;
+};
+
+class DigitalIn {
+public:
+    DigitalIn(PinName pin) : pin(pin) {}
+    DigitalIn(PinName pin, PinMode pull) : pin(pin) { mode(pull); }
+    int read() { return hostPinRead(pin); }
+    void mode(PinMode pull) { hostPinSetMode(pin, pull); }
+    operator int() { return read(); }
+
+private:
+    PinName pin;
+};
+
+class DigitalOut {
+public:
+    DigitalOut(PinName pin) : pin(pin) { hostPinSetOutput(pin, true); }
+    DigitalOut(PinName pin, int value) : pin(pin)
+    {
+        hostPinSetOutput(pin, true);
+        write(value);
+    }
+    void write(int value) { hostPinWrite(pin, value ? 1 : 0); }
+    int read() { return hostPinRead(pin); }
+    DigitalOut& operator=(int value) { write(value); return *this; }
+    DigitalOut& operator=(DigitalOut& rhs) { write(rhs.read()); return *this; }
+    operator int() { return read(); }
+
+private:
+    PinName pin;
+};
+
+class DigitalInOut {
+public:
+    DigitalInOut(PinName pin) : pin(pin) {}
+    void output() { hostPinSetOutput(pin, true); }
+    void input() { hostPinSetOutput(pin, false); }
+    void mode(PinMode pull) { hostPinSetMode(pin, pull); }
+    void write(int value) { hostPinWrite(pin, value ? 1 : 0); }
+    int read() { return hostPinRead(pin); }
+    DigitalInOut& operator=(int value) { write(value); return *this; }
+    operator int() { return read(); }
+
+private:
+    PinName pin;
+};
+
+// Edges are detected by sampling the pin each time simulated time moves.
+class InterruptIn {
+public:
+    InterruptIn(PinName pin) : pin(pin), irqEnabled(true), riseHandler(NULL),
+        fallHandler(NULL), lastLevel(-1) { hostInterruptInRegister(this); }
+    InterruptIn(const InterruptIn&) = delete;
+    InterruptIn& operator=(const InterruptIn&) = delete;
+
+    int read() { return hostPinRead(pin); }
+    void mode(PinMode pull) { hostPinSetMode(pin, pull); }
+    void rise(void (*func)()) { riseHandler = func; }
+    void fall(void (*func)()) { fallHandler = func; }
+    void enable_irq() { irqEnabled = true; }
+    void disable_irq() { irqEnabled = false; }
+    operator int() { return read(); }
+
+    // Called by the host HAL; fires the handler for a detected edge
+    void hostPoll()
+    {
+        int level = read();
+        if (irqEnabled && lastLevel == 1 && level == 0 && fallHandler != NULL) {
+            fallHandler();
+        } else if (irqEnabled && lastLevel == 0 && level == 1 && riseHandler != NULL) {
+            riseHandler();
+        }
+        lastLevel = read();
+    }
+
+private:
+    PinName pin;
+    bool irqEnabled;
+    void (*riseHandler)();
+    void (*fallHandler)();
+    int lastLevel;
+};
+
+// Periodic timer interrupt. Each expiry is scheduled from the previous one,
+// as the hardware ticker does, so the period does not drift.
+class Ticker {
+public:
+    Ticker() : handler(NULL), periodUs(0), expiryUs(0), periodic(true) {}
+    virtual ~Ticker() { detach(); }
+    Ticker(const Ticker&) = delete;
+    Ticker& operator=(const Ticker&) = delete;
+
+    void attach(void (*func)(), std::chrono::microseconds t)
+    {
+        handler = func;
+        periodUs = t.count();
+        expiryUs = hostClockUs() + periodUs;
+        hostTimeoutSchedule(this, expiryUs);
+    }
+    void detach() { hostTimeoutCancel(this); }
+
+    // Called by the host HAL at expiry
+    void hostFire()
+    {
+        if (periodic) {
+            expiryUs += periodUs;
+            hostTimeoutSchedule(this, expiryUs);
+        }
+        if (handler != NULL) {
+            handler();
+        }
+    }
+
+protected:
+    void (*handler)();
+    uint64_t periodUs;
+    uint64_t expiryUs;
+    bool periodic;
+};
+
+class Timeout : public Ticker {
+public:
+    Timeout() { periodic = false; }
+};
+
+// HAL analog input API, usable from interrupt context
+typedef struct analogin_s {
+    PinName pin;
+} analogin_t;
+
+inline void analogin_init(analogin_t* obj, PinName pin) { obj->pin = pin; }
+inline float analogin_read(analogin_t* obj) { return hostAnalogRead(obj->pin); }
+inline uint16_t analogin_read_u16(analogin_t* obj)
+{
+    return (uint16_t)(hostAnalogRead(obj->pin) * 65535.0f);
+}
+
+class SerialBase {
+public:
+    enum IrqType {
+        RxIrq = 0,
+        TxIrq
+    };
+};
+
+class UnbufferedSerial : public SerialBase {
+public:
+    UnbufferedSerial(PinName tx, PinName rx, int baud) { (void)tx; (void)rx; (void)baud; }
+    bool readable() { return hostUartReadable(); }
+    bool writable() { return hostUartWritable(); }
+    void attach(void (*func)(), IrqType type = RxIrq) { hostUartAttach(type, func); }
+
+    ssize_t read(void* buffer, size_t size)
+    {
+        char* bytes = (char*)buffer;
+        for (size_t i = 0; i < size; i++) {
+            bytes[i] = (char)hostUartGetc();
+        }
+        return size;
+    }
+
+    ssize_t write(const void* buffer, size_t size)
+    {
+        hostUartPut(buffer, size);
+        return size;
+    }
+};
+
+//=====[#include guards - end]=================================================
+
+#endif // _HOST_MBED_H_
@@ -0,0 +1,429 @@
+//=====[Libraries]=============================================================
+
+#include "mbed_host.h"
+
+//=====[Declaration of private defines]========================================
+
+#define HOST_UART_RX_BUFFER_SIZE    4096
+#define HOST_POLL_STEP_US           1000
+#define HOST_MAX_INTERRUPT_INS      16
+#define HOST_MAX_TIMEOUTS           16
+
+//=====[Declaration and initialization of private global variables]============
+
+static uint64_t clockUs = 0;
+static time_t rtcBaseSeconds = 0;
+
+static int pinLevel[HOST_PIN_COUNT];
+static bool pinIsOutput[HOST_PIN_COUNT];
+static PinMode pinMode[HOST_PIN_COUNT];
+static float analogLevel[HOST_PIN_COUNT];
+
+static char uartRxBuffer[HOST_UART_RX_BUFFER_SIZE];
+static size_t uartRxHead = 0;
+static size_t uartRxTail = 0;
+static bool uartEcho = true;
+static bool uartTimed = true;
+static uint64_t uartTxReadyUs = 0;
+static void (*uartIrqHandlers[2])() = { NULL, NULL };
+static bool inUartIrq = false;
+static int interruptNesting = 0;
+
+static hostClockListener_t clockListener = NULL;
+static hostInputResolver_t inputResolver = NULL;
+static hostPinListener_t pinListener = NULL;
+static hostInputSchedule_t inputSchedule = NULL;
+static hostIdleListener_t idleListener = NULL;
+
+static InterruptIn* interruptIns[HOST_MAX_INTERRUPT_INS];
+static int numberOfInterruptIns = 0;
+
+static Ticker* timeouts[HOST_MAX_TIMEOUTS];
+static uint64_t timeoutExpiryUs[HOST_MAX_TIMEOUTS];
+static int numberOfTimeouts = 0;
+
+static hostStats_t stats;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static uint64_t uartByteTimeUs();
+static void hostServiceUartIrqs(uint64_t untilUs);
+static void hostServiceTimeouts(uint64_t untilUs);
+static void hostServiceInterruptIns();
+
+//=====[Implementations of public functions]===================================
+
+uint64_t hostClockUs()
+{
+    return clockUs;
+}
+
+void hostClockAdvanceUs(uint64_t us)
+{
+    uint64_t targetUs = clockUs + us;
+
+    interruptNesting++;
+    hostServiceUartIrqs(targetUs);
+    hostServiceTimeouts(targetUs);
+    clockUs = targetUs;
+    if (clockListener != NULL) {
+        clockListener(clockUs);
+    }
+    hostServiceInterruptIns();
+    interruptNesting--;
+}
+
+// Earliest time at which a timer expires, the UART raises an interrupt or
+// the simulator changes an input, or UINT64_MAX if nothing is pending.
+uint64_t hostNextEventUs()
+{
+    uint64_t nextUs = inputSchedule != NULL ? inputSchedule() : UINT64_MAX;
+
+    for (int i = 0; i < numberOfTimeouts; i++) {
+        if (timeoutExpiryUs[i] < nextUs) {
+            nextUs = timeoutExpiryUs[i];
+        }
+    }
+    if (uartIrqHandlers[SerialBase::TxIrq] != NULL) {
+        uint64_t fireUs = uartTxReadyUs > clockUs ? uartTxReadyUs : clockUs;
+        if (fireUs < nextUs) {
+            nextUs = fireUs;
+        }
+    }
+    if (uartIrqHandlers[SerialBase::RxIrq] != NULL && hostUartReadable()) {
+        nextUs = clockUs;
+    }
+    return nextUs;
+}
+
+void hostIdle()
+{
+    if (idleListener != NULL) {
+        idleListener(clockUs);
+    }
+}
+
+// Handlers fired while the clock moves are this HAL's interrupt context.
+bool hostInInterrupt()
+{
+    return interruptNesting > 0;
+}
+
+void hostInterruptInRegister(InterruptIn* interruptIn)
+{
+    if (numberOfInterruptIns < HOST_MAX_INTERRUPT_INS) {
+        interruptIns[numberOfInterruptIns++] = interruptIn;
+    }
+}
+
+void hostTimeoutSchedule(Ticker* timeout, uint64_t expiryUs)
+{
+    hostTimeoutCancel(timeout);
+    if (numberOfTimeouts < HOST_MAX_TIMEOUTS) {
+        timeouts[numberOfTimeouts] = timeout;
+        timeoutExpiryUs[numberOfTimeouts] = expiryUs;
+        numberOfTimeouts++;
+    }
+}
+
+void hostTimeoutCancel(Ticker* timeout)
+{
+    for (int i = 0; i < numberOfTimeouts; i++) {
+        if (timeouts[i] == timeout) {
+            numberOfTimeouts--;
+            timeouts[i] = timeouts[numberOfTimeouts];
+            timeoutExpiryUs[i] = timeoutExpiryUs[numberOfTimeouts];
+            return;
+        }
+    }
+}
+
+void hostSetClockListener(hostClockListener_t listener)
+{
+    clockListener = listener;
+}
+
+void hostSetInputResolver(hostInputResolver_t resolver)
+{
+    inputResolver = resolver;
+}
+
+void hostSetPinListener(hostPinListener_t listener)
+{
+    pinListener = listener;
+}
+
+void hostSetInputSchedule(hostInputSchedule_t schedule)
+{
+    inputSchedule = schedule;
+}
+
+void hostSetIdleListener(hostIdleListener_t listener)
+{
+    idleListener = listener;
+}
+
+int hostPinRead(PinName pin)
+{
+    if (pin < 0 || pin >= HOST_PIN_COUNT) {
+        return 0;
+    }
+    if (!pinIsOutput[pin] && inputResolver != NULL) {
+        int level = inputResolver(pin);
+        if (level >= 0) {
+            return level;
+        }
+    }
+    return pinLevel[pin];
+}
+
+void hostPinWrite(PinName pin, int level)
+{
+    if (pin < 0 || pin >= HOST_PIN_COUNT) {
+        return;
+    }
+    int lastLevel = pinLevel[pin];
+    pinLevel[pin] = level;
+    stats.pinWrites++;
+    if (lastLevel != level) {
+        stats.pinChanges++;
+    }
+    if (pinListener != NULL) {
+        pinListener(pin, lastLevel, level);
+    }
+}
+
+void hostPinSetMode(PinName pin, PinMode mode)
+{
+    if (pin < 0 || pin >= HOST_PIN_COUNT) {
+        return;
+    }
+    pinMode[pin] = mode;
+    if (!pinIsOutput[pin] && mode == PullUp) {
+        pinLevel[pin] = 1;
+    }
+}
+
+void hostPinSetOutput(PinName pin, bool isOutput)
+{
+    if (pin < 0 || pin >= HOST_PIN_COUNT) {
+        return;
+    }
+    pinIsOutput[pin] = isOutput;
+}
+
+float hostAnalogRead(PinName pin)
+{
+    if (pin < 0 || pin >= HOST_PIN_COUNT) {
+        return 0.0;
+    }
+    return analogLevel[pin];
+}
+
+void hostSetAnalog(PinName pin, float value)
+{
+    analogLevel[pin] = value;
+}
+
+void hostSetPin(PinName pin, int level)
+{
+    pinLevel[pin] = level;
+}
+
+int hostPinLevel(PinName pin)
+{
+    return pinLevel[pin];
+}
+
+bool hostPinIsOutput(PinName pin)
+{
+    return pinIsOutput[pin];
+}
+
+bool hostUartReadable()
+{
+    return uartRxHead != uartRxTail;
+}
+
+bool hostUartWritable()
+{
+    return clockUs >= uartTxReadyUs;
+}
+
+void hostUartAttach(int irqType, void (*func)())
+{
+    uartIrqHandlers[irqType] = func;
+}
+
+// A blocking read with nothing queued lets simulated time pass until the
+// trace delivers a byte, as the real UART would.
+int hostUartGetc()
+{
+    while (!hostUartReadable()) {
+        hostClockAdvanceUs(HOST_POLL_STEP_US);
+    }
+    char receivedChar = uartRxBuffer[uartRxTail];
+    uartRxTail = (uartRxTail + 1) % HOST_UART_RX_BUFFER_SIZE;
+    stats.uartBytesRead++;
+    return receivedChar;
+}
+
+void hostUartInject(const char* bytes, size_t size)
+{
+    for (size_t i = 0; i < size; i++) {
+        size_t nextHead = (uartRxHead + 1) % HOST_UART_RX_BUFFER_SIZE;
+        if (nextHead == uartRxTail) {
+            return;
+        }
+        uartRxBuffer[uartRxHead] = bytes[i];
+        uartRxHead = nextHead;
+    }
+}
+
+// Each byte occupies the transmitter for one 115200 baud character time. A
+// write while it is busy blocks, i.e. simulated time passes until it is free.
+void hostUartPut(const void* buffer, size_t size)
+{
+    for (size_t i = 0; i < size; i++) {
+        if (!hostUartWritable()) {
+            hostClockAdvanceUs(uartTxReadyUs - clockUs);
+        }
+        if (uartEcho) {
+            fputc(((const char*)buffer)[i], stdout);
+        }
+        stats.uartBytesWritten++;
+        if (uartTimed) {
+            uartTxReadyUs = clockUs + uartByteTimeUs();
+        }
+    }
+}
+
+void hostUartSetEcho(bool echo)
+{
+    uartEcho = echo;
+}
+
+void hostUartSetTimed(bool timed)
+{
+    uartTimed = timed;
+}
+
+const hostStats_t* hostGetStats()
+{
+    return &stats;
+}
+
+void hostCountSleep()
+{
+    stats.sleepCalls++;
+}
+
+void thread_sleep_for(uint32_t millisec)
+{
+    ThisThread::sleep_for(Kernel::Clock::duration(millisec));
+}
+
+Kernel::Clock::time_point Kernel::Clock::now()
+{
+    return time_point(duration(clockUs / 1000));
+}
+
+uint32_t us_ticker_read()
+{
+    return (uint32_t)clockUs;
+}
+
+void wait_us(int us)
+{
+    hostClockAdvanceUs(us);
+}
+
+void core_util_critical_section_enter()
+{
+}
+
+void core_util_critical_section_exit()
+{
+}
+
+void set_time(time_t t)
+{
+    rtcBaseSeconds = t - (time_t)(clockUs / 1000000);
+}
+
+// Interposes the C library time() so the firmware's RTC follows the virtual
+// clock instead of the host wall clock.
+time_t time(time_t* t)
+{
+    time_t now = rtcBaseSeconds + (time_t)(clockUs / 1000000);
+    if (t != NULL) {
+        *t = now;
+    }
+    return now;
+}
+
+//=====[Implementations of private functions]==================================
+
+static uint64_t uartByteTimeUs()
+{
+    return (uint64_t)HOST_UART_BITS_PER_BYTE * 1000000 / HOST_UART_BAUD_RATE;
+}
+
+// Fires the TX interrupt at every character time up to untilUs, while it
+// stays attached. The clock is moved to each firing point so the handler
+// sees the transmitter as free. The RX interrupt fires once if bytes are
+// waiting.
+static void hostServiceUartIrqs(uint64_t untilUs)
+{
+    if (inUartIrq) {
+        return;
+    }
+    inUartIrq = true;
+    while (uartIrqHandlers[SerialBase::TxIrq] != NULL) {
+        uint64_t fireUs = uartTxReadyUs > clockUs ? uartTxReadyUs : clockUs;
+        if (fireUs > untilUs) {
+            break;
+        }
+        clockUs = fireUs;
+        uint64_t readyBeforeUs = uartTxReadyUs;
+        uartIrqHandlers[SerialBase::TxIrq]();
+        if (uartTxReadyUs == readyBeforeUs) {
+            break;
+        }
+    }
+    if (uartIrqHandlers[SerialBase::RxIrq] != NULL && hostUartReadable()) {
+        uartIrqHandlers[SerialBase::RxIrq]();
+    }
+    inUartIrq = false;
+}
+
+// Fires due timeouts in expiry order, moving the clock to each expiry. A
+// handler may re-arm its own or another timeout.
+static void hostServiceTimeouts(uint64_t untilUs)
+{
+    while (true) {
+        int next = -1;
+        for (int i = 0; i < numberOfTimeouts; i++) {
+            if (timeoutExpiryUs[i] <= untilUs &&
+                (next < 0 || timeoutExpiryUs[i] < timeoutExpiryUs[next])) {
+                next = i;
+            }
+        }
+        if (next < 0) {
+            return;
+        }
+        Ticker* timeout = timeouts[next];
+        if (timeoutExpiryUs[next] > clockUs) {
+            clockUs = timeoutExpiryUs[next];
+        }
+        hostTimeoutCancel(timeout);
+        timeout->hostFire();
+    }
+}
+
+static void hostServiceInterruptIns()
+{
+    for (int i = 0; i < numberOfInterruptIns; i++) {
+        interruptIns[i]->hostPoll();
+    }
+}
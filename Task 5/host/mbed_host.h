@@ -0,0 +1,65 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _MBED_HOST_H_
+#define _MBED_HOST_H_
+
+// Simulator-side controls of the host HAL declared in mbed.h. Firmware code
+// never includes this header.
+
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+
+//=====[Declaration of public defines]=========================================
+
+#define HOST_UART_BAUD_RATE    115200
+#define HOST_UART_BITS_PER_BYTE    10
+
+//=====[Declaration of public data types]======================================
+
+// Called every time the virtual clock moves, with the new time.
+typedef void (*hostClockListener_t)(uint64_t nowUs);
+
+// Returns the level of an input pin, or -1 to fall back to the pin table.
+typedef int (*hostInputResolver_t)(PinName pin);
+
+// Called on every digital write, with the previous and new level.
+typedef void (*hostPinListener_t)(PinName pin, int lastLevel, int level);
+
+// Returns the time of the next input change the simulator will apply, so
+// the clock stops there, or UINT64_MAX.
+typedef uint64_t (*hostInputSchedule_t)();
+
+// Called when every firmware thread is blocked, before the clock moves.
+typedef void (*hostIdleListener_t)(uint64_t nowUs);
+
+typedef struct hostStats {
+    uint64_t sleepCalls;
+    uint64_t uartBytesWritten;
+    uint64_t uartBytesRead;
+    uint64_t pinWrites;
+    uint64_t pinChanges;
+} hostStats_t;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+void hostSetClockListener(hostClockListener_t listener);
+void hostSetInputResolver(hostInputResolver_t resolver);
+void hostSetPinListener(hostPinListener_t listener);
+void hostSetInputSchedule(hostInputSchedule_t schedule);
+void hostSetIdleListener(hostIdleListener_t listener);
+
+void hostSetAnalog(PinName pin, float value);
+void hostSetPin(PinName pin, int level);
+int hostPinLevel(PinName pin);
+bool hostPinIsOutput(PinName pin);
+
+void hostUartInject(const char* bytes, size_t size);
+void hostUartSetEcho(bool echo);
+void hostUartSetTimed(bool timed);
+
+const hostStats_t* hostGetStats();
+
+//=====[#include guards - end]=================================================
+
+#endif // _MBED_HOST_H_
@@ -0,0 +1,289 @@
+//=====[Libraries]=============================================================
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "mbed.h"
+
+//=====[Declaration of private defines]========================================
+
+#define HOST_MAX_THREADS    8
+#define HOST_MAIN_THREAD    0
+#define HOST_NO_THREAD     -1
+
+//=====[Declaration of private data types]=====================================
+
+// A blocked thread becomes ready when a flag in waitFlags is set, when the
+// clock reaches wakeUpUs, or when thread joinId finishes.
+typedef struct hostThread {
+    osPriority priority;
+    void (*task)();
+    std::condition_variable* resume;
+    std::unique_lock<std::mutex>* cpu;      // held while the thread runs
+    bool finished;
+    bool blocked;
+    uint32_t flags;
+    uint32_t waitFlags;
+    uint64_t wakeUpUs;
+    int joinId;
+    uint64_t lastRunTurn;
+} hostThread_t;
+
+//=====[Declaration and initialization of private global variables]============
+
+// Whoever holds cpuMutex is the running thread; every other thread waits on
+// its resume condition. Kernel objects are never freed, so the simulator
+// may exit() from any thread.
+static std::mutex* cpuMutex = NULL;
+static hostThread_t threads[HOST_MAX_THREADS];
+static int numberOfThreads = 0;
+static int runningId = HOST_NO_THREAD;      // no kernel until the first start()
+static uint64_t turns = 0;
+static thread_local int currentId = HOST_MAIN_THREAD;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void kernelInit();
+static void kernelThreadInit(int id, osPriority priority, void (*task)());
+static void kernelThreadBody(int id);
+static bool kernelIsReady(const hostThread_t* thread);
+static int kernelHighestReady(int self);
+static void kernelSchedule();
+static void kernelIdle();
+static void kernelBlock(uint32_t waitFlags, uint64_t wakeUpUs, int joinId);
+static uint64_t kernelTimePointUs(Kernel::Clock::time_point time);
+
+//=====[Implementations of public functions]===================================
+
+Thread::Thread(osPriority priority, uint32_t stack_size, unsigned char* stack_mem,
+               const char* name)
+    : priority(priority), stackSize(stack_size), name(name), id(HOST_NO_THREAD)
+{
+    (void)stack_mem;
+}
+
+osStatus Thread::start(void (*task)())
+{
+    kernelInit();
+    if (id != HOST_NO_THREAD || numberOfThreads >= HOST_MAX_THREADS) {
+        return osError;
+    }
+    id = numberOfThreads++;
+    kernelThreadInit(id, priority, task);
+    std::thread(kernelThreadBody, id).detach();
+
+    // A higher-priority thread preempts its creator straight away
+    kernelSchedule();
+    return osOK;
+}
+
+osStatus Thread::join()
+{
+    if (id == HOST_NO_THREAD || runningId == HOST_NO_THREAD) {
+        return osError;
+    }
+    kernelBlock(0, UINT64_MAX, id);
+    return osOK;
+}
+
+// From interrupt context the woken thread runs once the interrupt returns,
+// i.e. when the clock stops moving; from a thread it may preempt the caller.
+uint32_t Thread::flags_set(uint32_t flags)
+{
+    if (id == HOST_NO_THREAD) {
+        return osError;
+    }
+    threads[id].flags |= flags;
+    uint32_t result = threads[id].flags;
+    if (!hostInInterrupt()) {
+        kernelSchedule();
+    }
+    return result;
+}
+
+void ThisThread::sleep_for(Kernel::Clock::duration rel_time)
+{
+    kernelBlock(0, hostClockUs() + (uint64_t)rel_time.count() * 1000, HOST_NO_THREAD);
+}
+
+void ThisThread::sleep_until(Kernel::Clock::time_point abs_time)
+{
+    kernelBlock(0, kernelTimePointUs(abs_time), HOST_NO_THREAD);
+}
+
+uint32_t ThisThread::flags_wait_any(uint32_t flags, bool clear)
+{
+    return flags_wait_any_until(flags, Kernel::Clock::time_point::max(), clear);
+}
+
+uint32_t ThisThread::flags_wait_any_until(uint32_t flags, Kernel::Clock::time_point abs_time,
+                                          bool clear)
+{
+    hostThread_t* self = &threads[currentId];
+
+    kernelBlock(flags, kernelTimePointUs(abs_time), HOST_NO_THREAD);
+    uint32_t result = self->flags;
+    if (clear) {
+        self->flags &= ~flags;
+    }
+    return result;
+}
+
+//=====[Implementations of private functions]==================================
+
+// The first start() turns the caller into the main thread of the kernel.
+static void kernelInit()
+{
+    if (cpuMutex != NULL) {
+        return;
+    }
+    cpuMutex = new std::mutex;
+    kernelThreadInit(HOST_MAIN_THREAD, osPriorityNormal, NULL);
+    threads[HOST_MAIN_THREAD].cpu = new std::unique_lock<std::mutex>(*cpuMutex);
+    numberOfThreads = 1;
+    runningId = HOST_MAIN_THREAD;
+}
+
+static void kernelThreadInit(int id, osPriority priority, void (*task)())
+{
+    hostThread_t* thread = &threads[id];
+
+    thread->priority = priority;
+    thread->task = task;
+    thread->resume = new std::condition_variable;
+    thread->cpu = NULL;
+    thread->finished = false;
+    thread->blocked = false;
+    thread->flags = 0;
+    thread->waitFlags = 0;
+    thread->wakeUpUs = UINT64_MAX;
+    thread->joinId = HOST_NO_THREAD;
+    thread->lastRunTurn = turns;
+}
+
+static void kernelThreadBody(int id)
+{
+    hostThread_t* self = &threads[id];
+
+    currentId = id;
+    self->cpu = new std::unique_lock<std::mutex>(*cpuMutex);
+    self->resume->wait(*self->cpu, [id] { return runningId == id; });
+
+    self->task();
+
+    self->finished = true;
+    kernelSchedule();
+    self->cpu->unlock();
+}
+
+static bool kernelIsReady(const hostThread_t* thread)
+{
+    if (thread->finished) {
+        return false;
+    }
+    return !thread->blocked ||
+           (thread->flags & thread->waitFlags) != 0 ||
+           hostClockUs() >= thread->wakeUpUs ||
+           (thread->joinId != HOST_NO_THREAD && threads[thread->joinId].finished);
+}
+
+// The running thread keeps the CPU against equal priorities; otherwise the
+// one that has waited longest goes first.
+static int kernelHighestReady(int self)
+{
+    int best = kernelIsReady(&threads[self]) ? self : HOST_NO_THREAD;
+
+    for (int id = 0; id < numberOfThreads; id++) {
+        if (id == self || !kernelIsReady(&threads[id])) {
+            continue;
+        }
+        if (best == HOST_NO_THREAD ||
+            threads[id].priority > threads[best].priority ||
+            (best != self && threads[id].priority == threads[best].priority &&
+             threads[id].lastRunTurn < threads[best].lastRunTurn)) {
+            best = id;
+        }
+    }
+    return best;
+}
+
+// Called by the running thread after it blocked, finished or readied
+// another thread. Returns once the caller is the running thread again.
+static void kernelSchedule()
+{
+    int self = currentId;
+    int next;
+
+    if (runningId == HOST_NO_THREAD) {
+        return;
+    }
+    while ((next = kernelHighestReady(self)) == HOST_NO_THREAD) {
+        kernelIdle();
+    }
+    if (next == self) {
+        return;
+    }
+
+    runningId = next;
+    threads[next].lastRunTurn = ++turns;
+    threads[next].resume->notify_one();
+    if (!threads[self].finished) {
+        threads[self].resume->wait(*threads[self].cpu, [self] { return runningId == self; });
+    }
+}
+
+// Every thread is blocked: move the clock to the next thing that can wake
+// one, firing the interrupts due on the way.
+static void kernelIdle()
+{
+    hostIdle();
+
+    uint64_t nextUs = hostNextEventUs();
+    uint64_t nowUs = hostClockUs();
+
+    for (int id = 0; id < numberOfThreads; id++) {
+        if (!threads[id].finished && threads[id].wakeUpUs < nextUs) {
+            nextUs = threads[id].wakeUpUs;
+        }
+    }
+    if (nextUs == UINT64_MAX) {
+        fflush(stdout);
+        fprintf(stderr, "rtos: every thread is blocked and nothing can wake one\n");
+        exit(1);
+    }
+    hostClockAdvanceUs(nextUs > nowUs ? nextUs - nowUs : 0);
+}
+
+static void kernelBlock(uint32_t waitFlags, uint64_t wakeUpUs, int joinId)
+{
+    hostThread_t* self = &threads[currentId];
+
+    hostCountSleep();
+
+    // Before the first thread starts, main() sleeps on the bare clock
+    if (runningId == HOST_NO_THREAD) {
+        if (waitFlags == 0 && wakeUpUs != UINT64_MAX && wakeUpUs > hostClockUs()) {
+            hostClockAdvanceUs(wakeUpUs - hostClockUs());
+        }
+        return;
+    }
+
+    self->blocked = true;
+    self->waitFlags = waitFlags;
+    self->wakeUpUs = wakeUpUs;
+    self->joinId = joinId;
+    kernelSchedule();
+    self->blocked = false;
+    self->waitFlags = 0;
+    self->wakeUpUs = UINT64_MAX;
+    self->joinId = HOST_NO_THREAD;
+}
+
+static uint64_t kernelTimePointUs(Kernel::Clock::time_point time)
+{
+    if (time == Kernel::Clock::time_point::max()) {
+        return UINT64_MAX;
+    }
+    return (uint64_t)time.time_since_epoch().count() * 1000;
+}
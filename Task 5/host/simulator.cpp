@@ -0,0 +1,382 @@
+//=====[Host simulator]========================================================
+//
+// Runs the unchanged firmware main() against the host HAL in mbed_host.cpp.
+// The firmware threads never wait in real time: whenever all of them are
+// blocked the virtual clock jumps to the next event (rtos_host.cpp), so a
+// trace of minutes runs in milliseconds. Build from the "Task 5" directory with:
+//
+//   g++ -O2 -std=c++14 -pthread -Ihost -I. *.cpp host/*.cpp -o simulator
+//
+// Environment:
+//   SIM_TRACE=<file>   input trace (see below); without it the board idles
+//   SIM_END_MS=<ms>    stop after this much simulated time (default 60000)
+//   SIM_QUIET=1        do not copy UART output to stdout
+//   SIM_LOG_PINS=1     log LED and siren changes to stderr
+//   SIM_LATENCY=1      end the report with a "latency" line for bench tools
+//   SIM_RTC=<s>        RTC seconds at power-up (default 0), e.g. to carry
+//                      a battery-backed clock over from a previous run
+//
+// Trace lines are "<time_ms> <command> [argument]", sorted by time:
+//   lm35 <0.0-1.0>     set the LM35 analog input
+//   mq2 <0.0-1.0>      set the MQ2 analog input
+//   button <0|1>       alarm test button level
+//   press <key>        hold a matrix keypad key ('1'..'9', '0', '*', '#', 'A'..'D')
+//   release            release the held key
+//   uart <text>        queue text on the UART receive line (\r and \n escapes)
+//   end                stop the simulation
+// Blank lines and lines starting with '#' are ignored.
+//
+//=============================================================================
+
+//=====[Libraries]=============================================================
+
+#include <chrono>
+
+#include "mbed_host.h"
+#include "sensor_sampler.h"
+#include "event_log.h"
+#include "profiler.h"
+
+//=====[Declaration of private defines]========================================
+
+#define SIM_MAX_TRACE_EVENTS       65536
+#define SIM_TRACE_TEXT_LENGTH      64
+#define SIM_DEFAULT_END_MS         60000
+#define SIM_KEYPAD_NUMBER_OF_ROWS  4
+#define SIM_KEYPAD_NUMBER_OF_COLS  4
+#define SIM_NOT_SEEN               UINT64_MAX
+
+//=====[Declaration of private data types]=====================================
+
+typedef enum {
+    SIM_EVENT_LM35,
+    SIM_EVENT_MQ2,
+    SIM_EVENT_BUTTON,
+    SIM_EVENT_PRESS,
+    SIM_EVENT_RELEASE,
+    SIM_EVENT_UART,
+    SIM_EVENT_END
+} simEventType_t;
+
+typedef struct simEvent {
+    uint64_t timeUs;
+    simEventType_t type;
+    float value;
+    char text[SIM_TRACE_TEXT_LENGTH];
+} simEvent_t;
+
+//=====[Declaration and initialization of private global variables]============
+
+// Board wiring, mirrored from main.cpp.
+static const PinName lm35Pin = A1;
+static const PinName mq2Pin = A3;
+static const PinName alarmTestButtonPin = BUTTON1;
+static const PinName sirenPinName = PE_10;
+static const PinName keypadRowPinNames[SIM_KEYPAD_NUMBER_OF_ROWS] = {PB_3, PB_5, PC_7, PA_15};
+static const PinName keypadColPinNames[SIM_KEYPAD_NUMBER_OF_COLS] = {PB_12, PB_13, PB_15, PC_6};
+static const char keypadKeys[] = "123A456B789C*0#D";
+
+static simEvent_t traceEvents[SIM_MAX_TRACE_EVENTS];
+static int numberOfTraceEvents = 0;
+static int nextTraceEvent = 0;
+static uint64_t endUs = (uint64_t)SIM_DEFAULT_END_MS * 1000;
+static int pressedKeyIndex = -1;
+static bool logPins = false;
+static bool reportLatency = false;
+
+// First time each alarm output was seen, for SIM_LATENCY
+static uint64_t firstSirenOnUs = SIM_NOT_SEEN;
+static uint64_t firstAlarmLedChangeUs = SIM_NOT_SEEN;
+static uint64_t firstGasEventUs = SIM_NOT_SEEN;
+static uint32_t eventLogCursor = 0;
+
+static std::chrono::steady_clock::time_point wallStart;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void simulatorInit();
+static void simulatorLoadTrace(const char* path);
+static void simulatorClockListener(uint64_t nowUs);
+static uint64_t simulatorInputSchedule();
+static void simulatorIdleListener(uint64_t nowUs);
+static int simulatorInputResolver(PinName pin);
+static void simulatorPinListener(PinName pin, int lastLevel, int level);
+static void simulatorReport();
+static void simulatorLatencyReport();
+static double simulatorMarkMs(uint64_t markUs);
+static void unescapeText(char* text);
+
+//=====[Implementations of private functions]==================================
+
+// Runs before the firmware's main() so the HAL is wired up when it starts.
+static struct simulatorStartup {
+    simulatorStartup() { simulatorInit(); }
+} startup;
+
+static void simulatorInit()
+{
+    const char* trace = getenv("SIM_TRACE");
+    const char* endMs = getenv("SIM_END_MS");
+    const char* rtcSeconds = getenv("SIM_RTC");
+
+    if (endMs != NULL) {
+        endUs = strtoull(endMs, NULL, 10) * 1000;
+    }
+    if (trace != NULL) {
+        simulatorLoadTrace(trace);
+    }
+    if (rtcSeconds != NULL) {
+        set_time((time_t)strtoull(rtcSeconds, NULL, 10));
+    }
+    hostUartSetEcho(getenv("SIM_QUIET") == NULL);
+    logPins = getenv("SIM_LOG_PINS") != NULL;
+    reportLatency = getenv("SIM_LATENCY") != NULL;
+
+    hostSetClockListener(simulatorClockListener);
+    hostSetInputResolver(simulatorInputResolver);
+    hostSetPinListener(simulatorPinListener);
+    hostSetInputSchedule(simulatorInputSchedule);
+    hostSetIdleListener(simulatorIdleListener);
+    simulatorClockListener(0);
+
+    wallStart = std::chrono::steady_clock::now();
+}
+
+static void simulatorLoadTrace(const char* path)
+{
+    FILE* file = fopen(path, "r");
+    char line[128];
+    char command[16];
+    char argument[SIM_TRACE_TEXT_LENGTH];
+    unsigned long long timeMs;
+
+    if (file == NULL) {
+        fprintf(stderr, "simulator: cannot open trace %s\n", path);
+        exit(1);
+    }
+
+    while (fgets(line, sizeof(line), file) != NULL &&
+           numberOfTraceEvents < SIM_MAX_TRACE_EVENTS) {
+        argument[0] = '\0';
+        if (line[0] == '#' ||
+            sscanf(line, "%llu %15s %63[^\r\n]", &timeMs, command, argument) < 2) {
+            continue;
+        }
+
+        simEvent_t* event = &traceEvents[numberOfTraceEvents];
+        event->timeUs = timeMs * 1000;
+        event->value = (float)atof(argument);
+        strcpy(event->text, argument);
+
+        if (strcmp(command, "lm35") == 0) {
+            event->type = SIM_EVENT_LM35;
+        } else if (strcmp(command, "mq2") == 0) {
+            event->type = SIM_EVENT_MQ2;
+        } else if (strcmp(command, "button") == 0) {
+            event->type = SIM_EVENT_BUTTON;
+        } else if (strcmp(command, "press") == 0) {
+            event->type = SIM_EVENT_PRESS;
+        } else if (strcmp(command, "release") == 0) {
+            event->type = SIM_EVENT_RELEASE;
+        } else if (strcmp(command, "uart") == 0) {
+            event->type = SIM_EVENT_UART;
+            unescapeText(event->text);
+        } else if (strcmp(command, "end") == 0) {
+            event->type = SIM_EVENT_END;
+        } else {
+            fprintf(stderr, "simulator: unknown trace command %s\n", command);
+            continue;
+        }
+        numberOfTraceEvents++;
+    }
+    fclose(file);
+}
+
+static void simulatorClockListener(uint64_t nowUs)
+{
+    while (nextTraceEvent < numberOfTraceEvents &&
+           traceEvents[nextTraceEvent].timeUs <= nowUs) {
+        simEvent_t* event = &traceEvents[nextTraceEvent];
+        const char* key;
+        nextTraceEvent++;
+
+        switch (event->type) {
+        case SIM_EVENT_LM35:
+            hostSetAnalog(lm35Pin, event->value);
+            break;
+        case SIM_EVENT_MQ2:
+            hostSetAnalog(mq2Pin, event->value);
+            break;
+        case SIM_EVENT_BUTTON:
+            hostSetPin(alarmTestButtonPin, event->value != 0.0f);
+            break;
+        case SIM_EVENT_PRESS:
+            key = strchr(keypadKeys, event->text[0]);
+            pressedKeyIndex = (key != NULL && event->text[0] != '\0') ?
+                              (int)(key - keypadKeys) : -1;
+            break;
+        case SIM_EVENT_RELEASE:
+            pressedKeyIndex = -1;
+            break;
+        case SIM_EVENT_UART:
+            hostUartInject(event->text, strlen(event->text));
+            break;
+        case SIM_EVENT_END:
+            endUs = event->timeUs;
+            break;
+        }
+    }
+
+    if (nowUs >= endUs) {
+        simulatorReport();
+        exit(0);
+    }
+}
+
+// Stops the clock at every trace event, so an input change is seen by the
+// next sample taken after it rather than after the next timer event.
+static uint64_t simulatorInputSchedule()
+{
+    if (nextTraceEvent < numberOfTraceEvents && traceEvents[nextTraceEvent].timeUs < endUs) {
+        return traceEvents[nextTraceEvent].timeUs;
+    }
+    return endUs;
+}
+
+// Runs at the exact time the firmware went idle, so an event published by
+// the last thread to run is stamped with the time it was published.
+static void simulatorIdleListener(uint64_t nowUs)
+{
+    eventLogEntry_t event;
+
+    while (eventLogRead(&eventLogCursor, &event)) {
+        if (event.code == EVENT_GAS_DET_ON && firstGasEventUs == SIM_NOT_SEEN) {
+            firstGasEventUs = nowUs;
+        }
+    }
+}
+
+// A column reads low while the held key's row is driven low.
+static int simulatorInputResolver(PinName pin)
+{
+    for (int col = 0; col < SIM_KEYPAD_NUMBER_OF_COLS; col++) {
+        if (pin != keypadColPinNames[col]) {
+            continue;
+        }
+        if (pressedKeyIndex >= 0 && pressedKeyIndex % SIM_KEYPAD_NUMBER_OF_COLS == col) {
+            PinName row = keypadRowPinNames[pressedKeyIndex / SIM_KEYPAD_NUMBER_OF_COLS];
+            return hostPinLevel(row) ? 1 : 0;
+        }
+        return 1;
+    }
+    return -1;
+}
+
+static void simulatorPinListener(PinName pin, int lastLevel, int level)
+{
+    const char* name;
+
+    if (pin == sirenPinName && hostPinIsOutput(pin) && level == 0 &&
+        firstSirenOnUs == SIM_NOT_SEEN) {
+        firstSirenOnUs = hostClockUs();
+    }
+    if (pin == LED1 && lastLevel != level && firstAlarmLedChangeUs == SIM_NOT_SEEN) {
+        firstAlarmLedChangeUs = hostClockUs();
+    }
+
+    if (!logPins || lastLevel == level) {
+        return;
+    }
+    switch (pin) {
+    case LED1: name = "alarmLed"; break;
+    case LED2: name = "systemBlockedLed"; break;
+    case LED3: name = "incorrectCodeLed"; break;
+    case PE_10: name = "sirenPin"; break;
+    default: return;
+    }
+    fflush(stdout);
+    fprintf(stderr, "[%10.3f ms] %s=%d\n", hostClockUs() / 1000.0, name, level);
+}
+
+static void simulatorReport()
+{
+    const hostStats_t* stats = hostGetStats();
+    std::chrono::duration<double, std::milli> wall =
+        std::chrono::steady_clock::now() - wallStart;
+    double simulatedMs = hostClockUs() / 1000.0;
+
+    fflush(stdout);
+    fprintf(stderr, "\n--- simulation report ---\n");
+    fprintf(stderr, "simulated time     %.1f ms\n", simulatedMs);
+    fprintf(stderr, "wall time          %.1f ms\n", wall.count());
+    fprintf(stderr, "speed              %.0fx real time\n",
+            wall.count() > 0.0 ? simulatedMs / wall.count() : 0.0);
+    fprintf(stderr, "wake-ups           %llu\n", (unsigned long long)stats->sleepCalls);
+    fprintf(stderr, "uart bytes tx/rx   %llu/%llu\n",
+            (unsigned long long)stats->uartBytesWritten,
+            (unsigned long long)stats->uartBytesRead);
+    fprintf(stderr, "pin writes/changes %llu/%llu\n",
+            (unsigned long long)stats->pinWrites,
+            (unsigned long long)stats->pinChanges);
+    const sensorSamplerStats_t* samplerStats = sensorSamplerStatsGet();
+    fprintf(stderr, "sensor samples     %lu in %lu blocks, %lu blocks overrun\n",
+            (unsigned long)samplerStats->samples, (unsigned long)samplerStats->blocks,
+            (unsigned long)samplerStats->blocksOverrun);
+    fprintf(stderr, "sample interval    %lu..%lu us\n",
+            (unsigned long)samplerStats->minIntervalUs,
+            (unsigned long)samplerStats->maxIntervalUs);
+    fprintf(stderr, "siren              %s\n",
+            hostPinIsOutput(sirenPinName) && !hostPinLevel(sirenPinName) ? "on" : "off");
+    if (reportLatency) {
+        simulatorLatencyReport();
+    }
+}
+
+// One line, times in simulated ms (-1 if never seen) and the mean host cost
+// of an alarm thread pass and of an event through the console's event
+// logging, for host/bench/bench_alarm_latency.cpp
+static void simulatorLatencyReport()
+{
+    unsigned long events = (unsigned long)eventLogNewestCursor();
+    unsigned long alarmPassNs = 0;
+    unsigned long eventNs = 0;
+
+#if PROFILER_ENABLED
+    const profilerProbeStats_t* alarmPass = profilerStatsGet(PROFILER_PROBE_ALARM_THREAD);
+    const profilerProbeStats_t* eventLog = profilerStatsGet(PROFILER_PROBE_EVENT_LOG);
+    if (alarmPass->count > 0) {
+        alarmPassNs = (unsigned long)(alarmPass->totalNs / alarmPass->count);
+    }
+    if (events > 0) {
+        eventNs = (unsigned long)(eventLog->totalNs / events);
+    }
+#endif
+
+    fprintf(stderr, "latency siren_ms=%.3f led_ms=%.3f event_ms=%.3f events=%lu dropped=%lu "
+            "alarm_pass_ns=%lu event_ns=%lu\n",
+            simulatorMarkMs(firstSirenOnUs), simulatorMarkMs(firstAlarmLedChangeUs),
+            simulatorMarkMs(firstGasEventUs), events, (unsigned long)eventLogDropped(),
+            alarmPassNs, eventNs);
+}
+
+static double simulatorMarkMs(uint64_t markUs)
+{
+    return markUs == SIM_NOT_SEEN ? -1.0 : markUs / 1000.0;
+}
+
+static void unescapeText(char* text)
+{
+    char* out = text;
+    for (char* in = text; *in != '\0'; in++) {
+        if (in[0] == '\\' && in[1] == 'r') {
+            *out++ = '\r';
+            in++;
+        } else if (in[0] == '\\' && in[1] == 'n') {
+            *out++ = '\n';
+            in++;
+        } else {
+            *out++ = *in;
+        }
+    }
+    *out = '\0';
+}
@@ -0,0 +1,581 @@
+//=====[Fleet simulator]=======================================================
+//
+// Steps thousands of independent alarm controllers over long stretches of
+// sensor data, for capacity planning and threshold tuning, and reports how
+// the aggregate tick rate scales from 1 to N worker threads.
+//
+// A controller is what the alarm thread owns on the board, without the
+// peripherals: an AlarmSystem<ALARM_CONFIG>, the event coalescer in front
+// of the event log, and an event summary in place of the log itself. One
+// tick is one sensor block (FLEET_BLOCK_SIZE frames at 100 Hz) followed by
+// detectorsUpdate() and transitionsUpdate(), as the firmware runs them.
+//
+// Controllers are the tasks of a work-stealing scheduler: each worker
+// steps the controllers in its own deque one batch of ticks at a time, and
+// an idle worker takes the oldest controller from another worker's deque.
+// Every controller only depends on its own input, so the results are the
+// same for any number of threads; the run fails if they are not.
+//
+// Inputs are simulator traces (see host/simulator.cpp; lm35, mq2, button
+// and press lines are replayed, the rest ignored), handed out round-robin,
+// or without traces a synthetic day cycle per controller with occasional
+// heat and gas episodes. Each controller adds its own sensor noise, and
+// an operator enters the code some minutes after its alarm goes off. Build
+// from the "Task 5" directory, with -DALARM_CONFIG=... for another variant:
+//
+//   g++ -O2 -std=c++14 -pthread -I. host/tools/fleet_simulator.cpp event_log.cpp -o fleet
+//   ./fleet [-n controllers] [-s seconds] [-b batch_ticks] [-j max_threads] [trace...]
+//
+//=============================================================================
+
+//=====[Libraries]=============================================================
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "alarm_system.h"
+#include "event_coalescer.h"
+#include "event_log.h"
+
+//=====[Declaration of private defines]========================================
+
+#define FLEET_BLOCK_SIZE                 5      // as SENSOR_BLOCK_SIZE
+#define FLEET_TICK_MS                   50      // as SENSOR_BLOCK_PERIOD_MS
+#define FLEET_TICKS_PER_MINUTE        1200
+#define FLEET_DEFAULT_CONTROLLERS      256
+#define FLEET_DEFAULT_SECONDS         3600
+#define FLEET_DEFAULT_BATCH_TICKS     FLEET_TICKS_PER_MINUTE
+#define FLEET_OPERATOR_DELAY_TICKS    (5 * FLEET_TICKS_PER_MINUTE)
+#define FLEET_NOISE_COUNTS             256
+#define FLEET_MAX_TRACE_EVENTS       65536
+
+#define FLEET_STRING(name)            FLEET_STRING_VALUE(name)
+#define FLEET_STRING_VALUE(name)      #name
+
+//=====[Declaration of private data types]=====================================
+
+typedef AlarmSystem<ALARM_CONFIG> alarmSystem_t;
+
+static_assert(ALARM_TRANSITION_ALARM_ON == 1 << EVENT_ALARM_ON &&
+              ALARM_TRANSITION_GAS_DET_ON == 1 << EVENT_GAS_DET_ON &&
+              ALARM_TRANSITION_OVER_TEMP_ON == 1 << EVENT_OVER_TEMP_ON,
+              "transition bits are counted by event code");
+
+typedef enum {
+    FLEET_TRACE_LM35,
+    FLEET_TRACE_MQ2,
+    FLEET_TRACE_BUTTON,
+    FLEET_TRACE_PRESS,
+    FLEET_TRACE_END
+} fleetTraceCommand_t;
+
+typedef struct fleetTraceEvent {
+    uint32_t tick;
+    uint8_t command;
+    char key;
+    uint16_t counts;
+} fleetTraceEvent_t;
+
+typedef struct fleetTrace {
+    std::vector<fleetTraceEvent_t> events;
+    uint32_t endTick;           // UINT32_MAX without an end line
+} fleetTrace_t;
+
+// What a controller went through, compared between runs
+typedef struct fleetSummary {
+    uint32_t events[EVENT_NUMBER_OF_CODES];     // occurrences, repeats included
+    uint32_t alarmTicks;
+    uint32_t deactivations;
+} fleetSummary_t;
+
+//=====[Declaration of private classes]========================================
+
+// One simulated board
+class FleetController {
+public:
+    FleetController() : coalescer(ALARM_CONFIG::eventCoalesceWindowMs) {}
+
+    void init(uint32_t seed, const fleetTrace_t* replay, uint32_t ticks)
+    {
+        alarmSystem.reset();
+        coalescer.reset();
+        memset(&summary, 0, sizeof(summary));
+        trace = replay;
+        traceIndex = 0;
+        tick = 0;
+        endTick = trace != NULL && trace->endTick < ticks ? trace->endTick : ticks;
+        random = seed != 0 ? seed : 1;
+        alarmOnTick = 0;
+        testButton = false;
+        ambientCounts = (uint16_t)(lm35CountsAtCelsius(16) + next() % 4 * 250);
+        cleanAirCounts = (uint16_t)(adcCountsAtFraction(0.08) + next() % 4096);
+        levels[SENSOR_KIND_TEMPERATURE] = ambientCounts;
+        levels[SENSOR_KIND_GAS] = cleanAirCounts;
+        episodeKind = SENSOR_NUMBER_OF_KINDS;
+        episodeEndTick = 0;
+    }
+
+    // Steps up to ticks ticks; false once the controller has reached its end
+    bool step(uint32_t ticks)
+    {
+        uint16_t frames[FLEET_BLOCK_SIZE][alarmSystem_t::sensorChannels];
+        uint32_t batchEnd = endTick - tick < ticks ? endTick : tick + ticks;
+
+        for (; tick < batchEnd; tick++) {
+            if (trace != NULL) {
+                traceApply();
+            } else {
+                episodeUpdate();
+            }
+            for (int i = 0; i < FLEET_BLOCK_SIZE; i++) {
+                for (int c = 0; c < alarmSystem_t::sensorChannels; c++) {
+                    int32_t sample = levels[ALARM_CONFIG::sensorKind(c)] +
+                                     (int32_t)(next() % (2 * FLEET_NOISE_COUNTS)) -
+                                     FLEET_NOISE_COUNTS;
+                    frames[i][c] = (uint16_t)(sample < 0 ? 0 : sample > 65535 ? 65535 : sample);
+                }
+            }
+            alarmSystem.framesProcess(frames);
+            alarmSystem.detectorsUpdate(testButton);
+            eventsUpdate();
+            operatorUpdate();
+        }
+        return tick < endTick;
+    }
+
+    const fleetSummary_t& summaryGet() const { return summary; }
+    uint32_t ticksGet() const { return tick; }
+
+private:
+    // Event log input as in alarmEventsUpdate(), counted instead of logged
+    void eventsUpdate()
+    {
+        uint32_t nowMs = tick * FLEET_TICK_MS;
+
+        coalescer.flush(nowMs, [this](int key, uint16_t count) {
+            summary.events[key % EVENT_NUMBER_OF_CODES] += count;
+        });
+        if (alarmSystem.transitionsUpdate() == 0) {
+            return;
+        }
+        for (int zone = 0; zone < alarmSystem_t::zones; zone++) {
+            uint8_t transitions = alarmSystem.zoneTransitionsGet(zone);
+            for (int code = 0; code < EVENT_NUMBER_OF_CODES; code++) {
+                if ((transitions & (1 << code)) &&
+                    coalescer.occur(zone * EVENT_NUMBER_OF_CODES + code, nowMs)) {
+                    summary.events[code]++;
+                }
+            }
+        }
+    }
+
+    // Synthetic input: the operator clears an alarm a few minutes after it
+    // goes off.
+    void operatorUpdate()
+    {
+        if (!alarmSystem.isAlarmOn()) {
+            alarmOnTick = tick;
+            return;
+        }
+        summary.alarmTicks++;
+        if (trace == NULL && tick - alarmOnTick >= FLEET_OPERATOR_DELAY_TICKS &&
+            alarmSystem.codeEnter(ALARM_CONFIG::zoneCode(0))) {
+            summary.deactivations++;
+            alarmOnTick = tick;
+        }
+    }
+
+    // A day cycle of 5 °C with, every few hours, a heat or gas
+    // episode of one to twenty minutes.
+    void episodeUpdate()
+    {
+        uint32_t dayTick = tick % (24 * 60 * FLEET_TICKS_PER_MINUTE);
+        uint32_t halfDay = 12 * 60 * FLEET_TICKS_PER_MINUTE;
+        uint32_t fromNoon = dayTick > halfDay ? dayTick - halfDay : halfDay - dayTick;
+        int32_t dayCounts = (int32_t)(lm35CountsAtCelsius(5) * (uint64_t)(halfDay - fromNoon) /
+                                      halfDay);
+
+        levels[SENSOR_KIND_TEMPERATURE] = (uint16_t)(ambientCounts + dayCounts);
+        levels[SENSOR_KIND_GAS] = cleanAirCounts;
+
+        if (tick >= episodeEndTick) {
+            episodeKind = SENSOR_NUMBER_OF_KINDS;
+            if (tick % FLEET_TICKS_PER_MINUTE == 0 && next() % (3 * 60) == 0) {
+                episodeKind = next() % 2 == 0 ? SENSOR_KIND_GAS : SENSOR_KIND_TEMPERATURE;
+                episodeEndTick = tick + (1 + next() % 20) * FLEET_TICKS_PER_MINUTE;
+                episodeCounts = episodeKind == SENSOR_KIND_GAS ?
+                                (uint16_t)(adcCountsAtFraction(0.3) + next() % 32768) :
+                                (uint16_t)(lm35CountsAtCelsius(22) + next() % 2048);
+            }
+        }
+        if (episodeKind != SENSOR_NUMBER_OF_KINDS) {
+            levels[episodeKind] = episodeCounts;
+        }
+    }
+
+    void traceApply()
+    {
+        while (traceIndex < trace->events.size() && trace->events[traceIndex].tick <= tick) {
+            const fleetTraceEvent_t* event = &trace->events[traceIndex];
+            switch (event->command) {
+            case FLEET_TRACE_LM35:
+                levels[SENSOR_KIND_TEMPERATURE] = event->counts;
+                break;
+            case FLEET_TRACE_MQ2:
+                levels[SENSOR_KIND_GAS] = event->counts;
+                break;
+            case FLEET_TRACE_BUTTON:
+                testButton = event->counts != 0;
+                break;
+            case FLEET_TRACE_PRESS:
+                if (alarmSystem.codeKeyEnter(event->key) == CODE_ENTRY_CORRECT) {
+                    summary.deactivations++;
+                }
+                break;
+            default:
+                break;
+            }
+            traceIndex++;
+        }
+    }
+
+    // xorshift32
+    uint32_t next()
+    {
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+        return random;
+    }
+
+    alarmSystem_t alarmSystem;
+    EventCoalescer<alarmSystem_t::zones * EVENT_NUMBER_OF_CODES> coalescer;
+    fleetSummary_t summary;
+
+    const fleetTrace_t* trace;
+    size_t traceIndex;
+    uint32_t tick;
+    uint32_t endTick;
+    uint32_t random;
+    uint32_t alarmOnTick;
+    bool testButton;
+    uint16_t levels[SENSOR_NUMBER_OF_KINDS];
+    uint16_t ambientCounts;
+    uint16_t cleanAirCounts;
+    sensorKind_t episodeKind;
+    uint32_t episodeEndTick;
+    uint16_t episodeCounts;
+};
+
+// Runs tasks on a fixed set of workers until all are done. Each worker
+// keeps a deque of task numbers: it takes and returns its own work at the
+// back, so a task stays on one worker while it has work, and when its
+// deque is empty it steals from the front of another worker's, where the
+// tasks nobody has started yet are. Tasks are coarse (a batch of ticks),
+// so a mutex per deque costs little next to the work.
+class WorkStealingScheduler {
+public:
+    explicit WorkStealingScheduler(int workers) : workers(workers), deques(workers) {}
+
+    // step(task) does one batch of a task and returns true if it has more.
+    // Returns the number of tasks stolen.
+    template <typename Step>
+    uint64_t run(int tasks, Step step)
+    {
+        std::vector<std::thread> threads;
+
+        for (int task = 0; task < tasks; task++) {
+            deques[task % workers].tasks.push_back(task);
+        }
+        remaining.store(tasks);
+        steals.store(0);
+        for (int worker = 1; worker < workers; worker++) {
+            threads.emplace_back([this, worker, &step] { workerRun(worker, step); });
+        }
+        workerRun(0, step);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        return steals.load();
+    }
+
+private:
+    struct TaskDeque {
+        std::mutex lock;
+        std::deque<int> tasks;
+    };
+
+    template <typename Step>
+    void workerRun(int self, Step& step)
+    {
+        uint32_t victimSeed = (uint32_t)self * 2654435761u + 1;
+        int task;
+
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            if (!pop(self, &task) && !steal(self, &victimSeed, &task)) {
+                std::this_thread::yield();
+                continue;
+            }
+            if (step(task)) {
+                std::lock_guard<std::mutex> guard(deques[self].lock);
+                deques[self].tasks.push_back(task);
+            } else {
+                remaining.fetch_sub(1, std::memory_order_release);
+            }
+        }
+    }
+
+    bool pop(int self, int* task)
+    {
+        std::lock_guard<std::mutex> guard(deques[self].lock);
+        if (deques[self].tasks.empty()) {
+            return false;
+        }
+        *task = deques[self].tasks.back();
+        deques[self].tasks.pop_back();
+        return true;
+    }
+
+    // Tries every other worker once, starting from a random one
+    bool steal(int self, uint32_t* seed, int* task)
+    {
+        *seed = *seed * 1664525u + 1013904223u;
+        for (int i = 0; i < workers - 1; i++) {
+            int victim = (int)((*seed >> 8) % (uint32_t)workers + i) % workers;
+            if (victim == self) {
+                continue;
+            }
+            std::lock_guard<std::mutex> guard(deques[victim].lock);
+            if (!deques[victim].tasks.empty()) {
+                *task = deques[victim].tasks.front();
+                deques[victim].tasks.pop_front();
+                steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    int workers;
+    std::vector<TaskDeque> deques;
+    std::atomic<int> remaining;
+    std::atomic<uint64_t> steals;
+};
+
+//=====[Declaration and initialization of private global variables]============
+
+static int numberOfControllers = FLEET_DEFAULT_CONTROLLERS;
+static uint32_t simulatedSeconds = FLEET_DEFAULT_SECONDS;
+static uint32_t batchTicks = FLEET_DEFAULT_BATCH_TICKS;
+static int maxThreads = 0;
+static std::vector<fleetTrace_t> traces;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static bool traceLoad(const char* path, fleetTrace_t* trace);
+static uint16_t countsAtFraction(float fraction);
+static double fleetRun(int threads, std::vector<fleetSummary_t>* summaries,
+                       uint64_t* ticks, uint64_t* steals);
+static void summaryPrint(const std::vector<fleetSummary_t>& summaries, uint64_t ticks);
+static void usage(const char* program);
+
+//=====[Implementations of public functions]===================================
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] == '-' && i + 1 >= argc) {
+            usage(argv[0]);
+            return 2;
+        }
+        if (strcmp(argv[i], "-n") == 0) {
+            numberOfControllers = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0) {
+            simulatedSeconds = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-b") == 0) {
+            batchTicks = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "-j") == 0) {
+            maxThreads = atoi(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 2;
+        } else {
+            traces.emplace_back();
+            if (!traceLoad(argv[i], &traces.back())) {
+                fprintf(stderr, "fleet: cannot read trace %s\n", argv[i]);
+                return 2;
+            }
+        }
+    }
+    if (maxThreads <= 0) {
+        maxThreads = (int)std::thread::hardware_concurrency();
+        maxThreads = maxThreads > 0 ? maxThreads : 1;
+    }
+    if (numberOfControllers <= 0 || batchTicks == 0 || simulatedSeconds == 0 ||
+        simulatedSeconds > UINT32_MAX / 1000 * FLEET_TICK_MS) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    printf("%d controllers (%s), up to %lu s each, %s input, batches of %lu ticks\n\n",
+           numberOfControllers, FLEET_STRING(ALARM_CONFIG), (unsigned long)simulatedSeconds,
+           traces.empty() ? "synthetic" : "trace", (unsigned long)batchTicks);
+    printf("threads     wall s     ticks/s     samples/s   speedup   steals\n");
+
+    std::vector<fleetSummary_t> reference;
+    double referenceRate = 0.0;
+    uint64_t ticks = 0;
+    bool identical = true;
+
+    for (int threads = 1; threads <= maxThreads;
+         threads = threads * 2 > maxThreads && threads < maxThreads ? maxThreads : threads * 2) {
+        std::vector<fleetSummary_t> summaries;
+        uint64_t steals;
+        double seconds = fleetRun(threads, &summaries, &ticks, &steals);
+        double rate = ticks / seconds;
+
+        if (threads == 1) {
+            reference = summaries;
+            referenceRate = rate;
+        } else if (memcmp(summaries.data(), reference.data(),
+                          reference.size() * sizeof(fleetSummary_t)) != 0) {
+            identical = false;
+        }
+        printf("%7d %10.3f %11.4g %13.4g %9.2f %8llu\n", threads, seconds, rate,
+               rate * FLEET_BLOCK_SIZE * alarmSystem_t::sensorChannels, rate / referenceRate,
+               (unsigned long long)steals);
+    }
+
+    printf("\n");
+    summaryPrint(reference, ticks);
+    if (!identical) {
+        printf("\nresults differ between thread counts\n");
+        return 1;
+    }
+    return 0;
+}
+
+//=====[Implementations of private functions]==================================
+
+// Same line format as the simulator's traces
+static bool traceLoad(const char* path, fleetTrace_t* trace)
+{
+    FILE* file = fopen(path, "r");
+    char line[128];
+    char command[16];
+    char argument[64];
+
+    if (file == NULL) {
+        return false;
+    }
+    trace->endTick = UINT32_MAX;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        unsigned long timeMs;
+        fleetTraceEvent_t event;
+
+        argument[0] = '\0';
+        if (line[0] == '#' || sscanf(line, "%lu %15s %63s", &timeMs, command, argument) < 2) {
+            continue;
+        }
+        event.tick = (uint32_t)(timeMs / FLEET_TICK_MS);
+        event.key = argument[0];
+        event.counts = 0;
+        if (strcmp(command, "lm35") == 0) {
+            event.command = FLEET_TRACE_LM35;
+            event.counts = countsAtFraction(strtof(argument, NULL));
+        } else if (strcmp(command, "mq2") == 0) {
+            event.command = FLEET_TRACE_MQ2;
+            event.counts = countsAtFraction(strtof(argument, NULL));
+        } else if (strcmp(command, "button") == 0) {
+            event.command = FLEET_TRACE_BUTTON;
+            event.counts = atoi(argument) != 0;
+        } else if (strcmp(command, "press") == 0) {
+            event.command = FLEET_TRACE_PRESS;
+        } else if (strcmp(command, "end") == 0) {
+            trace->endTick = event.tick;
+            continue;
+        } else {
+            continue;
+        }
+        if (trace->events.size() < FLEET_MAX_TRACE_EVENTS) {
+            trace->events.push_back(event);
+        }
+    }
+    fclose(file);
+    return true;
+}
+
+static uint16_t countsAtFraction(float fraction)
+{
+    fraction = fraction < 0.0f ? 0.0f : fraction > 1.0f ? 1.0f : fraction;
+    return (uint16_t)(fraction * 65535.0f + 0.5f);
+}
+
+// Steps every controller to its end on the given number of threads.
+// Returns the wall time in seconds.
+static double fleetRun(int threads, std::vector<fleetSummary_t>* summaries,
+                       uint64_t* ticks, uint64_t* steals)
+{
+    std::unique_ptr<FleetController[]> controllers(new FleetController[numberOfControllers]);
+    uint32_t endTick = simulatedSeconds * (1000 / FLEET_TICK_MS);
+    WorkStealingScheduler scheduler(threads);
+
+    for (int i = 0; i < numberOfControllers; i++) {
+        controllers[i].init(0x9E3779B9u * (uint32_t)(i + 1),
+                            traces.empty() ? NULL : &traces[i % traces.size()], endTick);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    *steals = scheduler.run(numberOfControllers, [&controllers](int task) {
+        return controllers[task].step(batchTicks);
+    });
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    *ticks = 0;
+    summaries->resize(numberOfControllers);
+    for (int i = 0; i < numberOfControllers; i++) {
+        (*summaries)[i] = controllers[i].summaryGet();
+        *ticks += controllers[i].ticksGet();
+    }
+    return elapsed.count() > 0.0 ? elapsed.count() : 1e-9;
+}
+
+static void summaryPrint(const std::vector<fleetSummary_t>& summaries, uint64_t ticks)
+{
+    uint64_t events[EVENT_NUMBER_OF_CODES] = {0};
+    uint64_t alarmTicks = 0;
+    uint64_t deactivations = 0;
+    int alarmed = 0;
+
+    for (const fleetSummary_t& summary : summaries) {
+        for (int code = 0; code < EVENT_NUMBER_OF_CODES; code++) {
+            events[code] += summary.events[code];
+        }
+        alarmTicks += summary.alarmTicks;
+        deactivations += summary.deactivations;
+        alarmed += summary.alarmTicks > 0 ? 1 : 0;
+    }
+
+    printf("simulated          %.1f controller-hours\n",
+           ticks * (FLEET_TICK_MS / 1000.0) / 3600.0);
+    printf("controllers        %d alarmed of %d\n", alarmed, (int)summaries.size());
+    for (int code = 0; code < EVENT_NUMBER_OF_CODES; code++) {
+        printf("%-18s %llu\n", eventLogCodeName(code), (unsigned long long)events[code]);
+    }
+    printf("alarm time         %.3f%%\n", ticks > 0 ? 100.0 * alarmTicks / ticks : 0.0);
+    printf("deactivations      %llu\n", (unsigned long long)deactivations);
+}
+
+static void usage(const char* program)
+{
+    fprintf(stderr, "usage: %s [-n controllers] [-s seconds] [-b batch_ticks] "
+                    "[-j max_threads] [trace...]\n", program);
+}
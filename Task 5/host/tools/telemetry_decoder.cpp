@@ -0,0 +1,107 @@
+//=====[Telemetry decoder]=====================================================
+//
+// Decodes the binary telemetry stream (see telemetry.h) from stdin into CSV
+// on stdout, one line per sample frame:
+//
+//   sequence,frame,state,sample0..sampleN-1,average0..averageN-1
+//
+// Anything between frames that is not a valid packet, such as console
+// text, goes to stderr. Build from the "Task 5" directory and feed it a
+// serial capture or the simulator's output:
+//
+//   g++ -O2 -std=c++14 -I. host/tools/telemetry_decoder.cpp telemetry.cpp crc16.cpp -o decoder
+//   SIM_TRACE=trace ./simulator | ./decoder > samples.csv
+
+//=====[Libraries]=============================================================
+
+#include <stdio.h>
+
+#include "telemetry.h"
+
+//=====[Declaration of private defines]========================================
+
+#define DECODER_MAX_FRAME_SIZE    4096
+
+//=====[Declaration and initialization of private global variables]============
+
+static uint8_t frame[DECODER_MAX_FRAME_SIZE];
+static size_t frameLength = 0;
+static bool frameTooLong = false;
+
+static unsigned long packetsDecoded = 0;
+static unsigned long framesRejected = 0;
+static unsigned long packetsLost = 0;
+static unsigned long bytesRead = 0;
+static bool haveSequence = false;
+static uint32_t lastSequence = 0;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void frameProcess();
+static void packetPrint(const telemetrySamples_t* packet);
+
+//=====[Main function]=========================================================
+
+int main()
+{
+    int byte;
+
+    while ((byte = getchar()) != EOF) {
+        bytesRead++;
+        if (byte == 0x00) {
+            frameProcess();
+            continue;
+        }
+        if (frameLength < DECODER_MAX_FRAME_SIZE) {
+            frame[frameLength++] = (uint8_t)byte;
+        } else {
+            frameTooLong = true;
+        }
+    }
+    frameProcess();
+
+    fprintf(stderr, "\n--- telemetry ---\n");
+    fprintf(stderr, "bytes read         %lu\n", bytesRead);
+    fprintf(stderr, "packets decoded    %lu\n", packetsDecoded);
+    fprintf(stderr, "packets lost       %lu\n", packetsLost);
+    fprintf(stderr, "frames rejected    %lu\n", framesRejected);
+    return 0;
+}
+
+//=====[Implementations of private functions]==================================
+
+static void frameProcess()
+{
+    telemetrySamples_t packet;
+
+    if (frameLength > 0) {
+        if (!frameTooLong && telemetryFrameDecode(frame, frameLength, &packet)) {
+            if (haveSequence && packet.sequence != lastSequence + 1) {
+                packetsLost += packet.sequence - lastSequence - 1;
+            }
+            haveSequence = true;
+            lastSequence = packet.sequence;
+            packetsDecoded++;
+            packetPrint(&packet);
+        } else {
+            framesRejected++;
+            fwrite(frame, 1, frameLength, stderr);
+        }
+    }
+    frameLength = 0;
+    frameTooLong = false;
+}
+
+static void packetPrint(const telemetrySamples_t* packet)
+{
+    for (int i = 0; i < packet->frames; i++) {
+        printf("%lu,%d,%u", (unsigned long)packet->sequence, i, packet->state);
+        for (int c = 0; c < packet->channels; c++) {
+            printf(",%u", packet->samples[i][c]);
+        }
+        for (int c = 0; c < packet->channels; c++) {
+            printf(",%u", packet->averages[c]);
+        }
+        printf("\n");
+    }
+}
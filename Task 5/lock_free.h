@@ -0,0 +1,101 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _LOCK_FREE_H_
+#define _LOCK_FREE_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+#include <atomic>
+
+//=====[Declaration of public classes]=========================================
+
+// Wait-free single-producer single-consumer queue. One thread (or ISR)
+// pushes and one thread pops; neither ever blocks or disables interrupts.
+// A push onto a full queue is refused and counted.
+template <typename T, int N>
+class SpscQueue {
+public:
+    static_assert(N > 0 && (N & (N - 1)) == 0, "queue size must be a power of two");
+
+    SpscQueue() : head(0), tail(0), overruns(0) {}
+
+    bool push(const T& item)
+    {
+        uint32_t position = head.load(std::memory_order_relaxed);
+        if (position - tail.load(std::memory_order_acquire) >= (uint32_t)N) {
+            overruns.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        items[position & (N - 1)] = item;
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T* item)
+    {
+        uint32_t position = tail.load(std::memory_order_relaxed);
+        if (position == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        *item = items[position & (N - 1)];
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool isEmpty() const
+    {
+        return tail.load(std::memory_order_acquire) == head.load(std::memory_order_acquire);
+    }
+
+    uint32_t overrunsGet() const { return overruns.load(std::memory_order_relaxed); }
+
+private:
+    T items[N];
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+    std::atomic<uint32_t> overruns;
+};
+
+// Latest-value mailbox for a single writer and any number of readers. The
+// writer never waits; a reader that overlaps a write copies again, so it
+// always gets one complete value. On a single core the writer must run at a
+// higher priority than every reader, or a reader that preempted it halfway
+// through a write would spin forever.
+template <typename T>
+class Seqlock {
+public:
+    Seqlock() : sequence(0), value() {}
+
+    void write(const T& newValue)
+    {
+        uint32_t next = sequence.load(std::memory_order_relaxed) + 1;
+        sequence.store(next, std::memory_order_relaxed);   // odd: write in progress
+        std::atomic_thread_fence(std::memory_order_release);
+        value = newValue;
+        sequence.store(next + 1, std::memory_order_release);
+    }
+
+    T read() const
+    {
+        while (true) {
+            uint32_t before = sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                continue;
+            }
+            T copy = value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence.load(std::memory_order_relaxed) == before) {
+                return copy;
+            }
+        }
+    }
+
+private:
+    std::atomic<uint32_t> sequence;
+    T value;
+};
+
+//=====[#include guards - end]=================================================
+
+#endif // _LOCK_FREE_H_
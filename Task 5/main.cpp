@@ -1,19 +1,54 @@
 #include "mbed.h"
 #include "arm_book_lib.h"
-
-#define NUMBER_OF_KEYS                           4
-#define BLINKING_TIME_GAS_ALARM               1000
-#define BLINKING_TIME_OVER_TEMP_ALARM          500
-#define BLINKING_TIME_GAS_AND_OVER_TEMP_ALARM  100
-#define NUMBER_OF_AVG_SAMPLES                   100
-#define OVER_TEMP_LEVEL                         25
-#define GAS_DETECTION_THRESHOLD                 0.4  // Analog voltage threshold for MQ2 (0-1.0)
-#define TIME_INCREMENT_MS                       10
-#define DEBOUNCE_KEY_TIME_MS                    40
-#define KEYPAD_NUMBER_OF_ROWS                    4
-#define KEYPAD_NUMBER_OF_COLS                    4
-#define EVENT_MAX_STORAGE                        5
-#define EVENT_NAME_MAX_LENGTH                   14
+#include "alarm_system.h"
+#include "lock_free.h"
+#include "uart_tx.h"
+#include "uart_print.h"
+#include "uart_rx.h"
+#include "event_log.h"
+#include "event_journal.h"
+#include "event_coalescer.h"
+#include "sensor_sampler.h"
+#include "profiler.h"
+#include "telemetry.h"
+#include "memory_layout.h"
+#include "warm_start.h"
+#include "output_pattern.h"
+#include "sensor_calibration.h"
+
+#define KEYPAD_RELEASE_POLL_MS                  20
+#if COMPACT_LAYOUT
+#define KEYPAD_QUEUE_SIZE                        8
+#define CONSOLE_MESSAGE_QUEUE_SIZE               8
+#else
+#define KEYPAD_QUEUE_SIZE                       16
+#define CONSOLE_MESSAGE_QUEUE_SIZE              16
+#endif
+#define ALARM_COMMAND_QUEUE_SIZE                 4
+#define TELEMETRY_QUEUE_SIZE                     4
+#define UART_POLL_PERIOD_MS                     50
+#define ALARM_THREAD_STACK_SIZE               2048
+#define CONSOLE_THREAD_STACK_SIZE             4096
+#define ALARM_THREAD_FLAG_SENSOR_BLOCK         0x1
+#define ALARM_THREAD_FLAG_COMMAND              0x2
+#define CONSOLE_THREAD_FLAG_MESSAGE            0x1
+#define EVENT_DISPLAY_COUNT                      5
+#define JOURNAL_EXPORT_PERIOD_S              86400
+#define JOURNAL_EXPORT_TX_THRESHOLD            (UART_TX_BUFFER_SIZE / 2)
+#define DATE_TIME_FIELD_MAX_DIGITS               4
+#define PROFILE_REPORT_TX_THRESHOLD            (UART_TX_BUFFER_SIZE / 2)
+#define FOOTPRINT_REPORT_TX_THRESHOLD          (UART_TX_BUFFER_SIZE / 2)
+#define ALARM_REPORT_KINDS                       3     // alarmReport_t bits
+// Longest detector window, the gas baseline or the averaging window, in s
+#define WARM_START_MAX_AGE_S                                                     \
+    (((ALARM_CONFIG::gasBaselineSamples > ALARM_CONFIG::averagingSamples ?      \
+       (uint32_t)ALARM_CONFIG::gasBaselineSamples :                             \
+       (uint32_t)ALARM_CONFIG::averagingSamples) +                              \
+      SENSOR_SAMPLE_RATE_HZ - 1) / SENSOR_SAMPLE_RATE_HZ)
+// Half the max age, so the newest record is young enough for a full restore
+#define WARM_START_SAVE_PERIOD_MS            (WARM_START_MAX_AGE_S * 1000 / 2)
+// Shortest gap between records, also after a change, to spare the flash
+#define WARM_START_MIN_GAP_MS                 5000
 
 typedef enum {
     MATRIX_KEYPAD_SCANNING,
@@ -21,13 +56,117 @@ typedef enum {
     MATRIX_KEYPAD_KEY_HOLD_PRESSED
 } matrixKeypadState_t;
 
-typedef struct systemEvent {
-    time_t seconds;
-    char typeOfEvent[EVENT_NAME_MAX_LENGTH];
-} systemEvent_t;
+typedef enum {
+    UART_COMMAND_IDLE,
+    UART_COMMAND_CODE_ENTRY,
+    UART_COMMAND_NEW_CODE_ENTRY,
+    UART_COMMAND_DATE_TIME_ENTRY
+} uartCommandState_t;
+
+typedef enum {
+    DATE_TIME_FIELD_YEAR,
+    DATE_TIME_FIELD_MONTH,
+    DATE_TIME_FIELD_DAY,
+    DATE_TIME_FIELD_HOUR,
+    DATE_TIME_FIELD_MINUTES,
+    DATE_TIME_FIELD_SECONDS,
+    DATE_TIME_NUMBER_OF_FIELDS
+} dateTimeField_t;
+
+// What warmStartRestore() took over
+typedef enum {
+    WARM_START_NONE,
+    WARM_START_SETTINGS,
+    WARM_START_FULL
+} warmStartKind_t;
+
+// Outputs played by the output pattern engine
+typedef enum {
+    OUTPUT_ALARM_LED,
+    OUTPUT_INCORRECT_CODE_LED,
+    OUTPUT_SYSTEM_BLOCKED_LED,
+    OUTPUT_SIREN,
+    NUMBER_OF_OUTPUTS
+} output_t;
+
+typedef struct dateTimePrompt {
+    const char* text;
+    int length;
+    int digits;
+} dateTimePrompt_t;
+
+typedef AlarmSystem<ALARM_CONFIG> alarmSystem_t;
+
+// Zone of an event, printed as ", Zone: n" by multi-zone variants only
+typedef struct zoneLabel {
+    int zone;
+} zoneLabel_t;
+
+// Working buffers of the console thread. Each is used within a single
+// call, so they share storage instead of each taking console stack.
+typedef union consoleScratch {
+    eventJournalRecord_t journalRecords[EVENT_DISPLAY_COUNT];
+    uint8_t telemetryPacket[TELEMETRY_PACKET_SIZE(SENSOR_SAMPLER_CHANNELS, SENSOR_BLOCK_SIZE)];
+} consoleScratch_t;
+
+// Occurrences merged into a report or event, printed as ", Count: n" above 1
+typedef struct countLabel {
+    uint32_t count;
+} countLabel_t;
+
+// Alarm state published by the alarm thread for the console
+typedef struct alarmSnapshot {
+    bool alarmOn;
+    bool gasDetected;
+    bool overTemp;
+    uint16_t lm35Counts;
+    uint16_t mq2Counts;
+    int32_t lm35CentiC;
+} alarmSnapshot_t;
+
+typedef enum {
+    ALARM_COMMAND_CODE_ENTER,
+    ALARM_COMMAND_CODE_SET
+} alarmCommandType_t;
+
+// Console request to the alarm thread
+typedef struct alarmCommand {
+    uint8_t type;
+    char keys[alarmSystem_t::codeLength];
+} alarmCommand_t;
+
+// Sensor block for the telemetry stream, with the averages after it and the
+// alarm state as of the previous detector pass
+typedef struct telemetryBlock {
+    sensorBlock_t block;
+    uint16_t averages[SENSOR_SAMPLER_CHANNELS];
+    uint8_t state;
+} telemetryBlock_t;
+
+typedef enum {
+    CONSOLE_MESSAGE_ALARM_REPORT,
+    CONSOLE_MESSAGE_ALARM_REPEATS,
+    CONSOLE_MESSAGE_KEYPAD_CODE,
+    CONSOLE_MESSAGE_UART_CODE,
+    CONSOLE_MESSAGE_SHOW_EVENTS
+} consoleMessageType_t;
+
+// Alarm thread output for the console. value holds the alarm reports or
+// the code entry result; count the repeats merged into an ALARM_REPEATS.
+typedef struct consoleMessage {
+    uint8_t type;
+    uint8_t value;
+    uint16_t zone;
+    uint32_t seconds;
+    uint16_t count;
+} consoleMessage_t;
+
+// The board has a 4x4 keypad and one siren, wired to the pins below
+static_assert(ALARM_CONFIG::keypadRows == 4 && ALARM_CONFIG::keypadCols == 4,
+              "keypad geometry does not match the board wiring");
+static_assert(ALARM_CONFIG::sirenOutputs == 1, "the board has a single siren output");
 
 DigitalIn alarmTestButton(BUTTON1);
-AnalogIn mq2(A3);
 
 DigitalOut alarmLed(LED1);
 DigitalOut incorrectCodeLed(LED3);
@@ -37,598 +176,1322 @@ DigitalInOut sirenPin(PE_10);
 
 UnbufferedSerial uartUsb(USBTX, USBRX, 115200);
 
-AnalogIn lm35(A1);
-
-DigitalOut keypadRowPins[KEYPAD_NUMBER_OF_ROWS] = {PB_3, PB_5, PC_7, PA_15};
-DigitalIn keypadColPins[KEYPAD_NUMBER_OF_COLS]  = {PB_12, PB_13, PB_15, PC_6};
-
-bool alarmState    = OFF;
-bool incorrectCode = false;
-bool overTempDetector = OFF;
-
-int numberOfIncorrectCodes = 0;
-int numberOfHashKeyReleasedEvents = 0;
-int keyBeingCompared    = 0;
-char codeSequence[NUMBER_OF_KEYS]   = { '1', '8', '0', '5' };
-char keyPressed[NUMBER_OF_KEYS] = { '0', '0', '0', '0' };
-int accumulatedTimeAlarm = 0;
-
-bool alarmLastState        = OFF;
-bool gasLastState          = OFF;
-bool tempLastState         = OFF;
-bool ICLastState           = OFF;
-bool SBLastState           = OFF;
-
-bool gasDetectorState          = OFF;
-bool overTempDetectorState     = OFF;
-
-float potentiometerReading = 0.0;
-float lm35ReadingsAverage  = 0.0;
-float lm35ReadingsSum      = 0.0;
-float lm35ReadingsArray[NUMBER_OF_AVG_SAMPLES];
-float lm35TempC            = 0.0;
-float mq2ReadingsAverage   = 0.0;
-float mq2ReadingsSum       = 0.0;
-float mq2ReadingsArray[NUMBER_OF_AVG_SAMPLES];
-
-int accumulatedDebounceMatrixKeypadTime = 0;
-int matrixKeypadCodeIndex = 0;
-char matrixKeypadLastKeyPressed = '\0';
-char matrixKeypadIndexToCharArray[] = {
-    '1', '2', '3', 'A',
-    '4', '5', '6', 'B',
-    '7', '8', '9', 'C',
-    '*', '0', '#', 'D',
+// Sensor bank channels, in ALARM_CONFIG channel order: LM35, MQ2
+const PinName sensorPins[SENSOR_SAMPLER_CHANNELS] = {A1, A3};
+static_assert(ALARM_CONFIG::sensorChannels == SENSOR_SAMPLER_CHANNELS,
+              "every sensor bank channel needs a sampled pin");
+static_assert(SENSOR_SAMPLER_CHANNELS <= TELEMETRY_MAX_CHANNELS &&
+              SENSOR_BLOCK_SIZE <= TELEMETRY_MAX_FRAMES,
+              "a sensor block must fit in one telemetry packet");
+
+DigitalOut keypadRowPins[ALARM_CONFIG::keypadRows] = {PB_3, PB_5, PC_7, PA_15};
+InterruptIn keypadColPin0(PB_12);
+InterruptIn keypadColPin1(PB_13);
+InterruptIn keypadColPin2(PB_15);
+InterruptIn keypadColPin3(PC_6);
+InterruptIn* keypadColPins[ALARM_CONFIG::keypadCols] = {
+    &keypadColPin0, &keypadColPin1, &keypadColPin2, &keypadColPin3
+};
+Timeout matrixKeypadTimeout;
+
+// The alarm thread has the highest priority and blocks only waiting for
+// its flags, which the sampler sets once per sensor block. It shares no lock
+// with the console, so the siren follows a detection within one sensor
+// block period plus the alarm thread's own run time, whatever the console
+// is doing. The alarm system, siren and LEDs belong to it alone; other
+// threads see a published snapshot and talk to it through queues.
+Thread alarmThread(osPriorityHigh, ALARM_THREAD_STACK_SIZE, NULL, "alarm");
+Thread consoleThread(osPriorityBelowNormal, CONSOLE_THREAD_STACK_SIZE, NULL, "console");
+
+alarmSystem_t alarmSystem;
+Seqlock<alarmSnapshot_t> alarmSnapshot;
+SpscQueue<alarmCommand_t, ALARM_COMMAND_QUEUE_SIZE> alarmCommandQueue;
+SpscQueue<consoleMessage_t, CONSOLE_MESSAGE_QUEUE_SIZE> consoleMessageQueue;
+std::atomic<uint32_t> consoleMessagesDropped(0);    // queue full, for the 'p' report
+uint32_t alarmCommandsDropped = 0;                  // console thread only
+SpscQueue<telemetryBlock_t, TELEMETRY_QUEUE_SIZE> telemetryQueue;
+std::atomic<bool> telemetryStreaming(false);
+
+// Repeated console reports and logged events, keyed by zone and kind
+EventCoalescer<alarmSystem_t::zones * ALARM_REPORT_KINDS>
+    alarmReportCoalescer(ALARM_CONFIG::eventCoalesceWindowMs);
+EventCoalescer<alarmSystem_t::zones * EVENT_NUMBER_OF_CODES>
+    alarmEventCoalescer(ALARM_CONFIG::eventCoalesceWindowMs);
+
+consoleScratch_t consoleScratch;
+
+// Alarm state for the next warm-start record. The alarm thread fills it
+// while warmStartStateReady is false; the console thread, which may wait
+// for the flash, saves it and clears the flag. A record is taken once a
+// period, so a restored filter is at most that old, and after any change
+// to the codes, the latches or the incorrect code count, though never
+// within WARM_START_MIN_GAP_MS of the previous one. With the default
+// variant's 460-byte record each of the two flash sectors is erased about
+// every three hours, and every 50 minutes while a change is made at every
+// chance.
+alarmSystem_t::State warmStartState;
+std::atomic<bool> warmStartStateReady(false);
+bool warmStartStateChanged = false;
+uint32_t warmStartLastSaveMs = 0;
+static_assert(WARM_START_MIN_GAP_MS <= WARM_START_SAVE_PERIOD_MS,
+              "a record must be due at least once per save period");
+
+uartCommandState_t uartCommandState = UART_COMMAND_IDLE;
+int keyBeingCompared = 0;
+char uartCodeKeys[alarmSystem_t::codeLength];
+int dateTimeFieldIndex = 0;
+int dateTimeDigitIndex = 0;
+char dateTimeDigits[DATE_TIME_FIELD_MAX_DIGITS + 1];
+int dateTimeValues[DATE_TIME_NUMBER_OF_FIELDS];
+const dateTimePrompt_t dateTimePrompts[DATE_TIME_NUMBER_OF_FIELDS] = {
+    { "\r\nType four digits for the current year (YYYY): ", 48, 4 },
+    { "Type two digits for the current month (01-12): ", 47, 2 },
+    { "Type two digits for the current day (01-31): ", 45, 2 },
+    { "Type two digits for the current hour (00-23): ", 46, 2 },
+    { "Type two digits for the current minutes (00-59): ", 49, 2 },
+    { "Type two digits for the current seconds (00-59): ", 49, 2 },
 };
-matrixKeypadState_t matrixKeypadState;
 
-int eventsIndex = 0;
-systemEvent_t arrayOfStoredEvents[EVENT_MAX_STORAGE];
+char matrixKeypadLastKeyPressed = '\0';
+volatile matrixKeypadState_t matrixKeypadState;
+
+// Released keys, pushed by the keypad interrupts for the alarm thread
+SpscQueue<char, KEYPAD_QUEUE_SIZE> matrixKeypadQueue;
+
+uint32_t eventLogReportCursor = 0;
+bool journalExportActive = false;
+uint32_t journalExportSequence = 0;
+
+bool profileReportActive = false;
+int profileReportProbe = 0;
+uint32_t profileReportLastBytesSent = 0;
+Kernel::Clock::time_point profileReportLastTime;
+
+bool footprintReportActive = false;
+int footprintReportLine = 0;
+uint32_t footprintReportTotal = 0;
+
+// Against the budgets in memory_layout.h; the 'm' report lists the same
+static_assert(sizeof(alarmSystem) + sizeof(alarmSnapshot) + sizeof(warmStartState) +
+              sizeof(alarmReportCoalescer) + sizeof(alarmEventCoalescer) +
+              sizeof(consoleScratch) <= ALARM_STATE_RAM_BUDGET,
+              "alarm state exceeds ALARM_STATE_RAM_BUDGET");
+static_assert(sizeof(alarmCommandQueue) + sizeof(matrixKeypadQueue) +
+              sizeof(consoleMessageQueue) + sizeof(telemetryQueue) <= THREAD_QUEUES_RAM_BUDGET,
+              "thread queues exceed THREAD_QUEUES_RAM_BUDGET for this layout");
+
+#ifdef TOOLCHAIN_GCC_ARM
+// Linker script symbols bounding the initialized and zeroed static RAM
+extern "C" char __data_start__[], __data_end__[], __bss_start__[], __bss_end__[];
+#endif
 
 void inputsInit();
 void outputsInit();
+void alarmThreadRun();
+void alarmThreadUpdate();
+void alarmSensorBlockReady();
 void alarmActivationUpdate();
+uint8_t alarmReportsCoalesce(int zone, uint8_t reports, uint32_t nowMs);
+void alarmOutputsUpdate();
+void alarmLedWrite(bool on);
+void incorrectCodeLedWrite(bool on);
+void systemBlockedLedWrite(bool on);
+void sirenWrite(bool on);
 void alarmDeactivationUpdate();
+void alarmCommandsUpdate();
+void alarmEventsUpdate();
+bool alarmEventPublish(eventCode_t code, int zone, uint32_t nowMs);
+uint32_t alarmClockMs();
+void alarmSnapshotPublish();
+void alarmWarmStartUpdate();
+warmStartKind_t warmStartRestore();
+void warmStartUpdate();
+void consoleMessagePost(uint8_t type, uint8_t value, uint16_t zone, uint32_t seconds,
+                        uint16_t count);
+void consoleThreadRun();
+void consoleThreadUpdate();
+void consoleMessagesUpdate();
+void telemetryBlockPost(const sensorBlock_t* block);
+void telemetryUpdate();
+void telemetryStreamingToggle();
 void uartTask();
+void uartCommandStart(char receivedChar);
+void uartCodeEntryUpdate(char receivedChar);
+void uartNewCodeEntryUpdate(char receivedChar);
+void uartDateTimeEntryUpdate(char receivedChar);
+bool alarmCommandSend(alarmCommandType_t type, const char* keys);
 void availableCommands();
-bool areEqual();
 void eventLogUpdate();
-void systemElementStateUpdate(bool lastState, bool currentState, const char* elementName);
-float celsiusToFahrenheit(float tempInCelsiusDegrees);
-float analogReadingScaledWithTheLM35Formula(float analogReading);
-void lm35ReadingsArrayInit();
-void mq2ReadingsArrayInit();
+void alarmReportPrint(int zone, uint8_t reports, uint16_t count, uint32_t seconds);
+void uartPrintPut(zoneLabel_t label);
+void uartPrintPut(countLabel_t label);
 void matrixKeypadInit();
 char matrixKeypadScan();
-char matrixKeypadUpdate();
+void matrixKeypadArm();
+void matrixKeypadColumnFall();
+void matrixKeypadDebounceExpired();
+void matrixKeypadReleasePoll();
 void displayEventLog();
+void displayJournalGasEvents();
+void journalExportStart();
+void journalExportUpdate();
+void profileReportStart();
+void profileReportUpdate();
+void profileReportProbePrint(profilerProbe_t probe);
+void footprintReportStart();
+void footprintReportUpdate();
+bool footprintEntryGet(int index, const char** name, uint32_t* bytes);
+void footprintStackPrint(const Thread* thread);
 
 int main()
 {
     inputsInit();
     outputsInit();
-    const char* message = "Enter Code 1805 to Deactivate Alarm\r\n";
-    uartUsb.write(message, strlen(message));
-    while (true) {
-        alarmActivationUpdate();
-        alarmDeactivationUpdate();
-        uartTask();
-        eventLogUpdate();
-        delay(TIME_INCREMENT_MS);
+    switch (warmStartRestore()) {
+    case WARM_START_FULL:
+        uartPrint("Warm start from saved state ", warmStartSequence(), "\r\n");
+        break;
+    case WARM_START_SETTINGS:
+        uartPrint("Codes restored from saved state ", warmStartSequence(), "\r\n");
+        break;
+    default:
+        break;
     }
+    uartTxWriteConst("Enter Code 1805 to Deactivate Alarm\r\n", 37);
+
+    alarmThread.start(alarmThreadRun);
+    consoleThread.start(consoleThreadRun);
+    alarmThread.join();
 }
 
 void inputsInit()
 {
-    lm35ReadingsArrayInit();
-    mq2ReadingsArrayInit();
+#if PROFILER_ENABLED
+    profilerInit();
+    // A sample period over one and a half nominal periods is a missed tick
+    profilerBudgetSet(PROFILER_PROBE_SAMPLE_PERIOD, 3 * 1000000000u / (2 * SENSOR_SAMPLE_RATE_HZ));
+    profilerBudgetSet(PROFILER_PROBE_ALARM_THREAD, SENSOR_BLOCK_PERIOD_MS * 1000000u);
+    profilerBudgetSet(PROFILER_PROBE_CONSOLE_THREAD, UART_POLL_PERIOD_MS * 1000000u);
+#endif
+    uartTxInit(&uartUsb);
+    uartRxInit(&uartUsb);
+    eventLogInit();
+    eventJournalInit();
+    alarmSystem.reset();
+    alarmSnapshotPublish();
+    warmStartLastSaveMs = alarmClockMs();
+    sensorSamplerInit(sensorPins, alarmSensorBlockReady);
     alarmTestButton.mode(PullDown);
     sirenPin.mode(OpenDrain);
-    sirenPin.input();
     matrixKeypadInit();
 }
 
+static_assert(NUMBER_OF_OUTPUTS <= OUTPUT_PATTERN_MAX_OUTPUTS, "too many pattern outputs");
+
+// The LEDs and the siren are only driven through their patterns, so the
+// pins are written when their level changes and blink from timers.
 void outputsInit()
 {
-    alarmLed = OFF;
-    incorrectCodeLed = OFF;
-    systemBlockedLed = OFF;
+    outputPatternInit(OUTPUT_ALARM_LED, alarmLedWrite);
+    outputPatternInit(OUTPUT_INCORRECT_CODE_LED, incorrectCodeLedWrite);
+    outputPatternInit(OUTPUT_SYSTEM_BLOCKED_LED, systemBlockedLedWrite);
+    outputPatternInit(OUTPUT_SIREN, sirenWrite);
 }
 
-void alarmActivationUpdate()
+void alarmLedWrite(bool on)
 {
-    static int lm35SampleIndex = 0;
-    static int mq2SampleIndex = 0;
-    static bool lastOverTempDetector = OFF; // Track last state of overTempDetector
-    static bool lastGasDetectorState = OFF; // Track last state of gasDetectorState
-    int i = 0;
-
-    // LM35 Temperature Sensor
-    lm35ReadingsArray[lm35SampleIndex] = lm35.read();
-    lm35SampleIndex++;
-    if (lm35SampleIndex >= NUMBER_OF_AVG_SAMPLES) {
-        lm35SampleIndex = 0;
-    }
-    
-    lm35ReadingsSum = 0.0;
-    for (i = 0; i < NUMBER_OF_AVG_SAMPLES; i++) {
-        lm35ReadingsSum += lm35ReadingsArray[i];
-    }
-    lm35ReadingsAverage = lm35ReadingsSum / NUMBER_OF_AVG_SAMPLES;
-    lm35TempC = analogReadingScaledWithTheLM35Formula(lm35ReadingsAverage);    
-    
-    if (lm35TempC > OVER_TEMP_LEVEL) {
-        overTempDetector = ON;
-    } else {
-        overTempDetector = OFF;
-    }
-
-    // MQ2 Gas Sensor
-    mq2ReadingsArray[mq2SampleIndex] = mq2.read();
-    mq2SampleIndex++;
-    if (mq2SampleIndex >= NUMBER_OF_AVG_SAMPLES) {
-        mq2SampleIndex = 0;
-    }
-    
-    mq2ReadingsSum = 0.0;
-    for (i = 0; i < NUMBER_OF_AVG_SAMPLES; i++) {
-        mq2ReadingsSum += mq2ReadingsArray[i];
-    }
-    mq2ReadingsAverage = mq2ReadingsSum / NUMBER_OF_AVG_SAMPLES;
-
-    // Gas Detection
-    if (mq2ReadingsAverage > GAS_DETECTION_THRESHOLD) {
-        gasDetectorState = ON;
-        if (!lastGasDetectorState) { // Print on transition to ON
-            time_t currentTime = time(NULL);
-            char str[100];
-            sprintf(str, "Event: GAS_DET_ON, Time: %s", ctime(&currentTime));
-            uartUsb.write(str, strlen(str));
-        }
-        if (!alarmLastState) {
-            alarmState = ON;
-        }
-    } else {
-        gasDetectorState = OFF;
-    }
-    lastGasDetectorState = gasDetectorState; // Update last state
-
-    // Over-Temperature Detection
-    if (overTempDetector) {
-        overTempDetectorState = ON;
-        if (!lastOverTempDetector) { // Print on transition to ON
-            time_t currentTime = time(NULL);
-            char str[100];
-            sprintf(str, "Event: OVER_TEMP_ON, Time: %s", ctime(&currentTime));
-            uartUsb.write(str, strlen(str));
-        }
+    alarmLed = on ? ON : OFF;
+}
+
+void incorrectCodeLedWrite(bool on)
+{
+    incorrectCodeLed = on ? ON : OFF;
+}
+
+void systemBlockedLedWrite(bool on)
+{
+    systemBlockedLed = on ? ON : OFF;
+}
+
+// Open drain: pulled low when on, released when off
+void sirenWrite(bool on)
+{
+    if (on) {
+        sirenPin.output();
+        sirenPin = LOW;
     } else {
-        overTempDetectorState = OFF;
-    }
-    lastOverTempDetector = overTempDetector; // Update last state
-
-    // Test Button
-    if (alarmTestButton) {             
-        overTempDetectorState = ON;
-        gasDetectorState = ON;
-        if (!lastGasDetectorState) { // Print gas event for test button
-            time_t currentTime = time(NULL);
-            char str[100];
-            sprintf(str, "Event: GAS_DET_ON, Time: %s", ctime(&currentTime));
-            uartUsb.write(str, strlen(str));
-        }
-        if (!lastOverTempDetector) { // Print over-temp event for test button
-            time_t currentTime = time(NULL);
-            char str[100];
-            sprintf(str, "Event: OVER_TEMP_ON, Time: %s", ctime(&currentTime));
-            uartUsb.write(str, strlen(str));
+        sirenPin.input();
+    }
+}
+
+void alarmThreadRun()
+{
+    while (true) {
+        ThisThread::flags_wait_any(ALARM_THREAD_FLAG_SENSOR_BLOCK | ALARM_THREAD_FLAG_COMMAND);
+        PROFILER_TIMED(PROFILER_PROBE_ALARM_THREAD, alarmThreadUpdate());
+    }
+}
+
+void alarmThreadUpdate()
+{
+    PROFILER_TIMED(PROFILER_PROBE_ALARM_ACTIVATION, alarmActivationUpdate());
+    PROFILER_TIMED(PROFILER_PROBE_ALARM_DEACTIVATION, alarmDeactivationUpdate());
+    alarmCommandsUpdate();
+    alarmOutputsUpdate();
+    alarmEventsUpdate();
+    alarmSnapshotPublish();
+    alarmWarmStartUpdate();
+}
+
+// Sampler interrupt
+void alarmSensorBlockReady()
+{
+    alarmThread.flags_set(ALARM_THREAD_FLAG_SENSOR_BLOCK);
+}
+
+// Runs the detectors once per batch of new sensor blocks; nothing to do
+// when only a command woke the thread.
+void alarmActivationUpdate()
+{
+    sensorBlock_t block;
+    bool sensorsUpdated = false;
+
+    // Feed every sample acquired since the last call through the filters
+    while (sensorSamplerGetBlock(&block)) {
+        alarmSystem.framesProcess(block.frames);
+        if (telemetryStreaming.load(std::memory_order_relaxed)) {
+            telemetryBlockPost(&block);
         }
-        if (!alarmLastState) {
-            alarmState = ON;
-            time_t currentTime = time(NULL);
-            char str[100];
-            sprintf(str, "Event: TEST_BUTTON_ON, Time: %s", ctime(&currentTime));
-            uartUsb.write(str, strlen(str));
+        sensorsUpdated = true;
+    }
+    if (!sensorsUpdated) {
+        return;
+    }
+
+    uint32_t nowMs = alarmClockMs();
+    alarmReportCoalescer.flush(nowMs, [](int key, uint16_t count) {
+        consoleMessagePost(CONSOLE_MESSAGE_ALARM_REPEATS, 1 << (key % ALARM_REPORT_KINDS),
+                           key / ALARM_REPORT_KINDS, (uint32_t)time(NULL), count);
+    });
+
+    if (alarmSystem.detectorsUpdate(alarmTestButton) != 0) {
+        uint32_t seconds = (uint32_t)time(NULL);
+        for (int zone = 0; zone < alarmSystem_t::zones; zone++) {
+            uint8_t reports = alarmReportsCoalesce(zone, alarmSystem.zoneReportsGet(zone), nowMs);
+            if (reports != 0) {
+                consoleMessagePost(CONSOLE_MESSAGE_ALARM_REPORT, reports, zone, seconds, 1);
+            }
         }
-        lastGasDetectorState = ON; // Update states for test button
-        lastOverTempDetector = ON;
     }
+}
 
-    // Alarm State Handling
-    if (alarmState) { 
-        accumulatedTimeAlarm += TIME_INCREMENT_MS;
-        sirenPin.output();                                     
-        sirenPin = LOW;                                
+// The reports that are not repeats within their coalescing window
+uint8_t alarmReportsCoalesce(int zone, uint8_t reports, uint32_t nowMs)
+{
+    uint8_t passed = 0;
 
-        if (gasDetectorState && overTempDetectorState) {
-            if (accumulatedTimeAlarm >= BLINKING_TIME_GAS_AND_OVER_TEMP_ALARM) {
-                accumulatedTimeAlarm = 0;
-                alarmLed = !alarmLed;
-            }
-        } else if (gasDetectorState) {
-            if (accumulatedTimeAlarm >= BLINKING_TIME_GAS_ALARM) {
-                accumulatedTimeAlarm = 0;
-                alarmLed = !alarmLed;
-            }
-        } else if (overTempDetectorState) {
-            if (accumulatedTimeAlarm >= BLINKING_TIME_OVER_TEMP_ALARM) {
-                accumulatedTimeAlarm = 0;
-                alarmLed = !alarmLed;
-            }
+    for (int kind = 0; kind < ALARM_REPORT_KINDS; kind++) {
+        uint8_t report = 1 << kind;
+        if ((reports & report) &&
+            alarmReportCoalescer.occur(zone * ALARM_REPORT_KINDS + kind, nowMs)) {
+            passed |= report;
         }
-    } else {
-        alarmLed = OFF;
-        gasDetectorState = OFF;
-        overTempDetectorState = OFF;
-        sirenPin.input();                                  
-        lastGasDetectorState = OFF; // Reset last states when alarm is OFF
-        lastOverTempDetector = OFF;
     }
+    return passed;
+}
+
+// Picks the patterns for the alarm state; the engine ignores a pattern
+// that is already playing. The alarm LED blinks at the period of the alarm
+// causes, lit from the moment the alarm goes off, and a change of cause
+// takes effect at the end of the current blink period.
+void alarmOutputsUpdate()
+{
+    bool sirenOn = (alarmSystem.sirenOutputsActive() & 1) != 0;
+    int blinkingTimeMs = alarmSystem.blinkingTimeMs();
+
+    outputPatternSet(OUTPUT_SIREN, outputPatternSteady(sirenOn));
+    outputPatternSet(OUTPUT_ALARM_LED, sirenOn && blinkingTimeMs > 0 ?
+                                       outputPatternBlink((uint16_t)blinkingTimeMs) :
+                                       outputPatternSteady(false));
+    outputPatternSet(OUTPUT_SYSTEM_BLOCKED_LED, outputPatternSteady(alarmSystem.isBlocked()));
 }
 
 void alarmDeactivationUpdate()
 {
-    if (numberOfIncorrectCodes < 5) {
-        char keyReleased = matrixKeypadUpdate();
-        if (keyReleased != '\0' && keyReleased != '#') {
-            keyPressed[matrixKeypadCodeIndex] = keyReleased;
-            if (matrixKeypadCodeIndex >= NUMBER_OF_KEYS - 1) {
-                if (areEqual()) {
-                    alarmState = OFF;
-                    numberOfIncorrectCodes = 0;
-                    matrixKeypadCodeIndex = 0;
-                    uartUsb.write("Alarm Deactivated\r\n", 19);
-                } else {
-                    incorrectCodeLed = ON;
-                    numberOfIncorrectCodes++;
-                    matrixKeypadCodeIndex = 0;
-                    uartUsb.write("Incorrect Code\r\n", 16);
-                }
-            } else {
-                matrixKeypadCodeIndex++;
-            }
+    char keyReleased;
+
+    // Keys pressed while blocked are ignored, and so is anything typed
+    // before the block, so none of it is taken as code once unblocked
+    if (alarmSystem.isBlocked()) {
+        while (matrixKeypadQueue.pop(&keyReleased)) {
         }
+        alarmSystem.codeKeysClear();
+        return;
+    }
+
+    while (matrixKeypadQueue.pop(&keyReleased)) {
         if (keyReleased == '#') {
-            displayEventLog();
+            consoleMessagePost(CONSOLE_MESSAGE_SHOW_EVENTS, 0, 0, 0, 0);
+            continue;
+        }
+
+        codeEntryResult_t result = alarmSystem.codeKeyEnter(keyReleased);
+        if (result == CODE_ENTRY_INCORRECT) {
+            outputPatternSet(OUTPUT_INCORRECT_CODE_LED, outputPatternSteady(true));
+        }
+        if (result != CODE_ENTRY_INCOMPLETE) {
+            consoleMessagePost(CONSOLE_MESSAGE_KEYPAD_CODE, result, 0, 0, 0);
+            warmStartStateChanged = true;
+        }
+        if (alarmSystem.isBlocked()) {
+            break;
         }
-    } else {
-        systemBlockedLed = ON;
     }
 }
 
-void uartTask()
+void alarmCommandsUpdate()
 {
-    char receivedChar = '\0';
-    char str[100];
-    int stringLength;
-    if (uartUsb.readable()) {
-        uartUsb.read(&receivedChar, 1);
-        switch (receivedChar) {
-        case '1':
-            if (alarmState) {
-                uartUsb.write("The alarm is activated\r\n", 24);
+    alarmCommand_t command;
+
+    while (alarmCommandQueue.pop(&command)) {
+        warmStartStateChanged = true;
+        switch (command.type) {
+        case ALARM_COMMAND_CODE_ENTER:
+            if (alarmSystem.codeEnter(command.keys)) {
+                outputPatternSet(OUTPUT_INCORRECT_CODE_LED, outputPatternSteady(false));
+                consoleMessagePost(CONSOLE_MESSAGE_UART_CODE, CODE_ENTRY_CORRECT, 0, 0, 0);
             } else {
-                uartUsb.write("The alarm is not activated\r\n", 28);
+                outputPatternSet(OUTPUT_INCORRECT_CODE_LED, outputPatternSteady(true));
+                consoleMessagePost(CONSOLE_MESSAGE_UART_CODE, CODE_ENTRY_INCORRECT, 0, 0, 0);
             }
             break;
 
-        case '2':
-            if (mq2ReadingsAverage > GAS_DETECTION_THRESHOLD) {
-                uartUsb.write("Gas is being detected\r\n", 22);
-            } else {
-                uartUsb.write("Gas is not being detected\r\n", 27);
-            }
+        case ALARM_COMMAND_CODE_SET:
+            // The console changes the code of the first zone
+            alarmSystem.codeSet(0, command.keys);
             break;
 
-        case '3':
-            if (overTempDetector) {
-                uartUsb.write("Temperature is above the maximum level\r\n", 40);
-            } else {
-                uartUsb.write("Temperature is below the maximum level\r\n", 40);
-            }
+        default:
             break;
-            
-        case '4':
-            uartUsb.write("Please enter the four digits numeric code ", 42);
-            uartUsb.write("to deactivate the alarm: ", 25);
-
-            incorrectCode = false;
-
-            for (keyBeingCompared = 0; keyBeingCompared < NUMBER_OF_KEYS; keyBeingCompared++) {
-                uartUsb.read(&receivedChar, 1);
-                uartUsb.write("*", 1);
-                if (codeSequence[keyBeingCompared] != receivedChar) {
-                    incorrectCode = true;
-                }
-            }
+        }
+    }
+}
 
-            if (!incorrectCode) {
-                uartUsb.write("\r\nThe code is correct\r\n\r\n", 25);
-                alarmState = OFF;
-                incorrectCodeLed = OFF;
-                numberOfIncorrectCodes = 0;
-            } else {
-                uartUsb.write("\r\nThe code is incorrect\r\n\r\n", 27);
-                incorrectCodeLed = ON;
-                numberOfIncorrectCodes++;
+// Detector transitions go to the event log, which the console thread
+// reports and journals. Repeats within the coalescing window are logged as
+// one entry with their count when the window closes.
+void alarmEventsUpdate()
+{
+    uint8_t transitions;
+    uint32_t nowMs = alarmClockMs();
+    bool published = false;
+
+    eventLogClockUpdate(time(NULL));
+
+    alarmEventCoalescer.flush(nowMs, [&published](int key, uint16_t count) {
+        eventLogPublish((eventCode_t)(key % EVENT_NUMBER_OF_CODES),
+                        key / EVENT_NUMBER_OF_CODES, count);
+        published = true;
+    });
+
+    if (alarmSystem.transitionsUpdate() != 0) {
+        warmStartStateChanged = true;
+        for (int zone = 0; zone < alarmSystem_t::zones; zone++) {
+            transitions = alarmSystem.zoneTransitionsGet(zone);
+            if (transitions & ALARM_TRANSITION_ALARM_ON) {
+                published |= alarmEventPublish(EVENT_ALARM_ON, zone, nowMs);
             }
-            break;
+            if (transitions & ALARM_TRANSITION_GAS_DET_ON) {
+                published |= alarmEventPublish(EVENT_GAS_DET_ON, zone, nowMs);
+            }
+            if (transitions & ALARM_TRANSITION_OVER_TEMP_ON) {
+                published |= alarmEventPublish(EVENT_OVER_TEMP_ON, zone, nowMs);
+            }
+        }
+    }
+    if (published) {
+        consoleThread.flags_set(CONSOLE_THREAD_FLAG_MESSAGE);
+    }
+}
 
-        case '5':
-            uartUsb.write("Please enter the new four digits numeric code ", 46);
-            uartUsb.write("to deactivate the alarm: ", 25);
+bool alarmEventPublish(eventCode_t code, int zone, uint32_t nowMs)
+{
+    if (!alarmEventCoalescer.occur(zone * EVENT_NUMBER_OF_CODES + code, nowMs)) {
+        return false;
+    }
+    eventLogPublish(code, zone, 1);
+    return true;
+}
 
-            for (keyBeingCompared = 0; keyBeingCompared < NUMBER_OF_KEYS; keyBeingCompared++) {
-                uartUsb.write("*", 1);
-                uartUsb.read(&receivedChar, 1);
-                codeSequence[keyBeingCompared] = receivedChar;
-            }
+// Kernel clock in milliseconds, wrapping every 49 days, for the coalescers
+uint32_t alarmClockMs()
+{
+    return (uint32_t)Kernel::Clock::now().time_since_epoch().count();
+}
 
-            uartUsb.write("\r\nNew code generated\r\n\r\n", 24);
-            break;
+void alarmSnapshotPublish()
+{
+    alarmSnapshot_t snapshot;
+
+    snapshot.alarmOn = alarmSystem.isAlarmOn();
+    snapshot.gasDetected = alarmSystem.isGasDetected();
+    snapshot.overTemp = alarmSystem.isOverTemp();
+    snapshot.lm35Counts = alarmSystem.lm35Counts();
+    snapshot.mq2Counts = alarmSystem.mq2Counts();
+    snapshot.lm35CentiC = alarmSystem.lm35CentiCelsius();
+    alarmSnapshot.write(snapshot);
+}
 
-        case 'c':
-        case 'C':
-            sprintf(str, "Temperature: %.2f \xB0 C\r\n", lm35TempC);
-            stringLength = strlen(str);
-            uartUsb.write(str, stringLength);
-            break;
+// Hands the alarm state to the console thread for a warm-start record when
+// one is due and the previous one has been saved.
+void alarmWarmStartUpdate()
+{
+    uint32_t nowMs = alarmClockMs();
+    uint32_t sinceSaveMs = nowMs - warmStartLastSaveMs;
+
+    // A change stays pending until the gap has passed
+    if (warmStartStateReady.load(std::memory_order_acquire) ||
+        sinceSaveMs < (warmStartStateChanged ? WARM_START_MIN_GAP_MS : WARM_START_SAVE_PERIOD_MS)) {
+        return;
+    }
+    alarmSystem.stateSave(&warmStartState);
+    warmStartStateReady.store(true, std::memory_order_release);
+    warmStartStateChanged = false;
+    warmStartLastSaveMs = nowMs;
+    consoleThread.flags_set(CONSOLE_THREAD_FLAG_MESSAGE);
+}
+
+// Before the threads start: takes over the newest warm-start record, if
+// this build wrote it and it checks, so the detectors run on full filter
+// windows from the first sensor block. A record saved longer ago than the
+// longest detector window, or after the RTC's current time as after a
+// power loss, no longer describes the air: only its codes and incorrect
+// code count are taken and the detectors start afresh.
+warmStartKind_t warmStartRestore()
+{
+    uint32_t savedSeconds;
+
+    if (!warmStartInit() ||
+        !warmStartLoad(alarmSystem_t::stateLayout, &warmStartState, sizeof(warmStartState),
+                       &savedSeconds)) {
+        return WARM_START_NONE;
+    }
+    uint32_t nowSeconds = (uint32_t)time(NULL);
+    if (nowSeconds >= savedSeconds && nowSeconds - savedSeconds <= WARM_START_MAX_AGE_S) {
+        return alarmSystem.stateRestore(warmStartState) ? WARM_START_FULL : WARM_START_NONE;
+    }
+    return alarmSystem.settingsRestore(warmStartState) ? WARM_START_SETTINGS : WARM_START_NONE;
+}
+
+void warmStartUpdate()
+{
+    if (warmStartStateReady.load(std::memory_order_acquire)) {
+        warmStartSave(alarmSystem_t::stateLayout, &warmStartState, sizeof(warmStartState));
+        warmStartStateReady.store(false, std::memory_order_release);
+    }
+}
+
+void telemetryBlockPost(const sensorBlock_t* block)
+{
+    telemetryBlock_t telemetry;
+
+    telemetry.block = *block;
+    for (int channel = 0; channel < SENSOR_SAMPLER_CHANNELS; channel++) {
+        telemetry.averages[channel] = alarmSystem.channelCounts(channel);
+    }
+    telemetry.state = (alarmSystem.isAlarmOn() ? TELEMETRY_STATE_ALARM_ON : 0) |
+                      (alarmSystem.isGasDetected() ? TELEMETRY_STATE_GAS : 0) |
+                      (alarmSystem.isOverTemp() ? TELEMETRY_STATE_OVER_TEMP : 0) |
+                      (alarmSystem.isBlocked() ? TELEMETRY_STATE_BLOCKED : 0);
+    telemetryQueue.push(telemetry);
+    consoleThread.flags_set(CONSOLE_THREAD_FLAG_MESSAGE);
+}
+
+void consoleMessagePost(uint8_t type, uint8_t value, uint16_t zone, uint32_t seconds,
+                        uint16_t count)
+{
+    consoleMessage_t message = { type, value, zone, seconds, count };
+
+    if (!consoleMessageQueue.push(message)) {
+        consoleMessagesDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    consoleThread.flags_set(CONSOLE_THREAD_FLAG_MESSAGE);
+}
+
+// Lowest priority: everything that writes to the UART runs here, so the
+// transmit queue keeps a single producer. Wakes when the alarm thread posts
+// and otherwise polls the receiver every UART_POLL_PERIOD_MS.
+void consoleThreadRun()
+{
+    Kernel::Clock::time_point nextPollTime = Kernel::Clock::now();
+
+    while (true) {
+        while (nextPollTime <= Kernel::Clock::now()) {
+            nextPollTime += std::chrono::milliseconds(UART_POLL_PERIOD_MS);
+        }
+        ThisThread::flags_wait_any_until(CONSOLE_THREAD_FLAG_MESSAGE, nextPollTime);
+        PROFILER_TIMED(PROFILER_PROBE_CONSOLE_THREAD, consoleThreadUpdate());
+    }
+}
+
+void consoleThreadUpdate()
+{
+    consoleMessagesUpdate();
+    telemetryUpdate();
+    PROFILER_TIMED(PROFILER_PROBE_UART_TASK, uartTask());
+    PROFILER_TIMED(PROFILER_PROBE_EVENT_LOG, eventLogUpdate());
+    warmStartUpdate();
+}
 
-        case 'f':
-        case 'F':
-            sprintf(str, "Temperature: %.2f \xB0 F\r\n", celsiusToFahrenheit(lm35TempC));
-            stringLength = strlen(str);
-            uartUsb.write(str, stringLength);
+void consoleMessagesUpdate()
+{
+    consoleMessage_t message;
+
+    while (consoleMessageQueue.pop(&message)) {
+        switch (message.type) {
+        case CONSOLE_MESSAGE_ALARM_REPORT:
+        case CONSOLE_MESSAGE_ALARM_REPEATS:
+            alarmReportPrint(message.zone, message.value, message.count, message.seconds);
             break;
-            
-        case 's':
-        case 'S':
-            struct tm rtcTime;
-            int strIndex;
-                    
-            uartUsb.write("\r\nType four digits for the current year (YYYY): ", 48);
-            for (strIndex = 0; strIndex < 4; strIndex++) {
-                uartUsb.read(&str[strIndex], 1);
-                uartUsb.write(&str[strIndex], 1);
-            }
-            str[4] = '\0';
-            rtcTime.tm_year = atoi(str) - 1900;
-            uartUsb.write("\r\n", 2);
-
-            uartUsb.write("Type two digits for the current month (01-12): ", 47);
-            for (strIndex = 0; strIndex < 2; strIndex++) {
-                uartUsb.read(&str[strIndex], 1);
-                uartUsb.write(&str[strIndex], 1);
-            }
-            str[2] = '\0';
-            rtcTime.tm_mon = atoi(str) - 1;
-            uartUsb.write("\r\n", 2);
-
-            uartUsb.write("Type two digits for the current day (01-31): ", 45);
-            for (strIndex = 0; strIndex < 2; strIndex++) {
-                uartUsb.read(&str[strIndex], 1);
-                uartUsb.write(&str[strIndex], 1);
-            }
-            str[2] = '\0';
-            rtcTime.tm_mday = atoi(str);
-            uartUsb.write("\r\n", 2);
-
-            uartUsb.write("Type two digits for the current hour (00-23): ", 46);
-            for (strIndex = 0; strIndex < 2; strIndex++) {
-                uartUsb.read(&str[strIndex], 1);
-                uartUsb.write(&str[strIndex], 1);
-            }
-            str[2] = '\0';
-            rtcTime.tm_hour = atoi(str);
-            uartUsb.write("\r\n", 2);
-
-            uartUsb.write("Type two digits for the current minutes (00-59): ", 49);
-            for (strIndex = 0; strIndex < 2; strIndex++) {
-                uartUsb.read(&str[strIndex], 1);
-                uartUsb.write(&str[strIndex], 1);
-            }
-            str[2] = '\0';
-            rtcTime.tm_min = atoi(str);
-            uartUsb.write("\r\n", 2);
-
-            uartUsb.write("Type two digits for the current seconds (00-59): ", 49);
-            for (strIndex = 0; strIndex < 2; strIndex++) {
-                uartUsb.read(&str[strIndex], 1);
-                uartUsb.write(&str[strIndex], 1);
-            }
-            str[2] = '\0';
-            rtcTime.tm_sec = atoi(str);
-            uartUsb.write("\r\n", 2);
 
-            rtcTime.tm_isdst = -1;
-            set_time(mktime(&rtcTime));
-            uartUsb.write("Date and time has been set\r\n", 28);
+        case CONSOLE_MESSAGE_KEYPAD_CODE:
+            if (message.value == CODE_ENTRY_CORRECT) {
+                uartTxWriteConst("Alarm Deactivated\r\n", 19);
+            } else {
+                uartTxWriteConst("Incorrect Code\r\n", 16);
+            }
             break;
-                        
-        case 't':
-        case 'T':
-            time_t epochSeconds;
-            epochSeconds = time(NULL);
-            sprintf(str, "Date and Time = %s", ctime(&epochSeconds));
-            uartUsb.write(str, strlen(str));
-            uartUsb.write("\r\n", 2);
+
+        case CONSOLE_MESSAGE_UART_CODE:
+            if (message.value == CODE_ENTRY_CORRECT) {
+                uartTxWriteConst("\r\nThe code is correct\r\n\r\n", 25);
+            } else {
+                uartTxWriteConst("\r\nThe code is incorrect\r\n\r\n", 27);
+            }
             break;
 
-        case 'e':
-        case 'E':
+        case CONSOLE_MESSAGE_SHOW_EVENTS:
             displayEventLog();
             break;
 
         default:
-            availableCommands();
             break;
         }
     }
 }
 
-void availableCommands()
+// count is 1 for a single report; more for a summary of repeats
+void alarmReportPrint(int zone, uint8_t reports, uint16_t count, uint32_t seconds)
 {
-    uartUsb.write("Available commands:\r\n", 21);
-    uartUsb.write("Press '1' to get the alarm state\r\n", 34);
-    uartUsb.write("Press '2' to get the gas detector state\r\n", 41);
-    uartUsb.write("Press '3' to get the over temperature detector state\r\n", 54);
-    uartUsb.write("Press '4' to enter the code sequence\r\n", 38);
-    uartUsb.write("Press '5' to enter a new code\r\n", 31);
-    uartUsb.write("Press 'f' or 'F' to get lm35 reading in Fahrenheit\r\n", 52);
-    uartUsb.write("Press 'c' or 'C' to get lm35 reading in Celsius\r\n", 49);
-    uartUsb.write("Press 's' or 'S' to set the date and time\r\n", 43);
-    uartUsb.write("Press 't' or 'T' to get the date and time\r\n", 43);
-    uartUsb.write("Press 'e' or 'E' to get the stored events\r\n\r\n", 45);
+    zoneLabel_t label = { zone };
+    countLabel_t repeats = { count };
+
+    if (reports & ALARM_REPORT_GAS_DET_ON) {
+        uartPrint("Event: GAS_DET_ON", label, repeats, ", Time: ", printDateTime(seconds), "\n");
+    }
+    if (reports & ALARM_REPORT_OVER_TEMP_ON) {
+        uartPrint("Event: OVER_TEMP_ON", label, repeats,
+                  ", Time: ", printDateTime(seconds), "\n");
+    }
+    if (reports & ALARM_REPORT_TEST_BUTTON_ON) {
+        uartPrint("Event: TEST_BUTTON_ON", label, repeats,
+                  ", Time: ", printDateTime(seconds), "\n");
+    }
 }
 
-bool areEqual()
+void uartPrintPut(zoneLabel_t label)
 {
-    for (int i = 0; i < NUMBER_OF_KEYS; i++) {
-        if (codeSequence[i] != keyPressed[i]) {
-            return false;
-        }
+    if (alarmSystem_t::zones > 1) {
+        uartPrintPut(", Zone: ");
+        uartPrintPutSigned(label.zone);
     }
-    return true;
 }
 
-void eventLogUpdate()
+void uartPrintPut(countLabel_t label)
 {
-    systemElementStateUpdate(alarmLastState, alarmState, "ALARM");
-    alarmLastState = alarmState;
+    if (label.count > 1) {
+        uartPrintPut(", Count: ");
+        uartPrintPutUnsigned(label.count);
+    }
+}
 
-    systemElementStateUpdate(gasLastState, gasDetectorState, "GAS_DET");
-    gasLastState = gasDetectorState;
+// Consumes every byte received since the last call. Multi-character
+// commands ('4', '5', 's') keep their progress in uartCommandState, so the
+// console never waits for the user. Replies from the alarm thread are
+// printed after each byte, in order with the echo.
+void uartTask()
+{
+    char receivedChar = '\0';
+    while (uartRxRead(&receivedChar)) {
+        switch (uartCommandState) {
+        case UART_COMMAND_CODE_ENTRY:
+            uartCodeEntryUpdate(receivedChar);
+            break;
 
-    systemElementStateUpdate(tempLastState, overTempDetector, "OVER_TEMP");
-    tempLastState = overTempDetector;
+        case UART_COMMAND_NEW_CODE_ENTRY:
+            uartNewCodeEntryUpdate(receivedChar);
+            break;
+
+        case UART_COMMAND_DATE_TIME_ENTRY:
+            uartDateTimeEntryUpdate(receivedChar);
+            break;
+
+        case UART_COMMAND_IDLE:
+        default:
+            uartCommandStart(receivedChar);
+            break;
+        }
+        consoleMessagesUpdate();
+    }
+    journalExportUpdate();
+    profileReportUpdate();
+    footprintReportUpdate();
 }
 
-void systemElementStateUpdate(bool lastState, bool currentState, const char* elementName)
+void uartCommandStart(char receivedChar)
 {
-    char eventAndStateStr[EVENT_NAME_MAX_LENGTH] = "";
+    alarmSnapshot_t snapshot = alarmSnapshot.read();
+
+    switch (receivedChar) {
+    case '1':
+        if (snapshot.alarmOn) {
+            uartTxWriteConst("The alarm is activated\r\n", 24);
+        } else {
+            uartTxWriteConst("The alarm is not activated\r\n", 28);
+        }
+        break;
 
-    // Only log ON transitions for ALARM, GAS_DET, and OVER_TEMP
-    if (lastState != currentState && currentState) {
-        strcat(eventAndStateStr, elementName);
-        strcat(eventAndStateStr, "_ON");
+    case '2':
+        if (snapshot.gasDetected) {
+            uartTxWriteConst("Gas is being detected\r\n", 22);
+        } else {
+            uartTxWriteConst("Gas is not being detected\r\n", 27);
+        }
+        break;
 
-        if (eventsIndex >= EVENT_MAX_STORAGE) {
-            for (int i = 1; i < EVENT_MAX_STORAGE; i++) {
-                arrayOfStoredEvents[i-1] = arrayOfStoredEvents[i];
-            }
-            eventsIndex = EVENT_MAX_STORAGE - 1;
+    case '3':
+        if (snapshot.overTemp) {
+            uartTxWriteConst("Temperature is above the maximum level\r\n", 40);
+        } else {
+            uartTxWriteConst("Temperature is below the maximum level\r\n", 40);
         }
+        break;
+        
+    case '4':
+        uartTxWriteConst("Please enter the four digits numeric code ", 42);
+        uartTxWriteConst("to deactivate the alarm: ", 25);
+        keyBeingCompared = 0;
+        uartCommandState = UART_COMMAND_CODE_ENTRY;
+        break;
+
+    case '5':
+        uartTxWriteConst("Please enter the new four digits numeric code ", 46);
+        uartTxWriteConst("to deactivate the alarm: ", 25);
+        keyBeingCompared = 0;
+        uartCommandState = UART_COMMAND_NEW_CODE_ENTRY;
+        break;
+
+    case 'c':
+    case 'C':
+        uartPrint("Temperature: ", printFixed(snapshot.lm35CentiC, 2), " \xB0 C\r\n");
+        break;
+
+    case 'f':
+    case 'F':
+        uartPrint("Temperature: ", printFixed(centiCelsiusToCentiFahrenheit(snapshot.lm35CentiC), 2),
+                  " \xB0 F\r\n");
+        break;
+
+    case 'g':
+    case 'G':
+        uartPrint("Gas: LPG ", mq2PpmTable<Mq2Lpg>.lookup(snapshot.mq2Counts),
+                  " ppm, CO ", mq2PpmTable<Mq2CarbonMonoxide>.lookup(snapshot.mq2Counts),
+                  " ppm, smoke ", mq2PpmTable<Mq2Smoke>.lookup(snapshot.mq2Counts), " ppm\r\n");
+        break;
+        
+    case 's':
+    case 'S':
+        dateTimeFieldIndex = 0;
+        dateTimeDigitIndex = 0;
+        uartTxWriteConst(dateTimePrompts[0].text, dateTimePrompts[0].length);
+        uartCommandState = UART_COMMAND_DATE_TIME_ENTRY;
+        break;
+                    
+    case 't':
+    case 'T':
+        uartPrint("Date and Time = ", printDateTime(time(NULL)), "\n\r\n");
+        break;
+
+    case 'e':
+    case 'E':
+        displayEventLog();
+        break;
+
+    case 'j':
+    case 'J':
+        displayJournalGasEvents();
+        break;
+
+    case 'x':
+    case 'X':
+        journalExportStart();
+        break;
+
+    case 'p':
+    case 'P':
+        profileReportStart();
+        break;
+
+    case 'b':
+    case 'B':
+        telemetryStreamingToggle();
+        break;
+
+    case 'm':
+    case 'M':
+        footprintReportStart();
+        break;
+
+    case '\r':
+    case '\n':
+        // Line terminators from line-buffered terminals are not commands
+        break;
+
+    default:
+        availableCommands();
+        break;
+    }
+}
+
+// The alarm thread checks the code and posts the result back
+void uartCodeEntryUpdate(char receivedChar)
+{
+    uartTxWriteConst("*", 1);
+    uartCodeKeys[keyBeingCompared] = receivedChar;
+    keyBeingCompared++;
+    if (keyBeingCompared < alarmSystem_t::codeLength) {
+        return;
+    }
+
+    if (!alarmCommandSend(ALARM_COMMAND_CODE_ENTER, uartCodeKeys)) {
+        uartTxWriteConst("\r\nCode not checked, try again\r\n\r\n", 33);
+    }
+    uartCommandState = UART_COMMAND_IDLE;
+}
 
-        arrayOfStoredEvents[eventsIndex].seconds = time(NULL);
-        strcpy(arrayOfStoredEvents[eventsIndex].typeOfEvent, eventAndStateStr);
-        eventsIndex++;
+void uartNewCodeEntryUpdate(char receivedChar)
+{
+    uartTxWriteConst("*", 1);
+    uartCodeKeys[keyBeingCompared] = receivedChar;
+    keyBeingCompared++;
+    if (keyBeingCompared < alarmSystem_t::codeLength) {
+        return;
+    }
 
-        uartUsb.write(eventAndStateStr, strlen(eventAndStateStr));
-        uartUsb.write("\r\n", 2);
+    if (alarmCommandSend(ALARM_COMMAND_CODE_SET, uartCodeKeys)) {
+        uartTxWriteConst("\r\nNew code generated\r\n\r\n", 24);
+    } else {
+        uartTxWriteConst("\r\nCode not changed, try again\r\n\r\n", 33);
     }
+    uartCommandState = UART_COMMAND_IDLE;
 }
 
-float analogReadingScaledWithTheLM35Formula(float analogReading)
+void uartDateTimeEntryUpdate(char receivedChar)
 {
-    return (analogReading * 3.3 / 0.01);
+    uartTxWrite(&receivedChar, 1);
+    dateTimeDigits[dateTimeDigitIndex] = receivedChar;
+    dateTimeDigitIndex++;
+    if (dateTimeDigitIndex < dateTimePrompts[dateTimeFieldIndex].digits) {
+        return;
+    }
+
+    dateTimeDigits[dateTimeDigitIndex] = '\0';
+    dateTimeValues[dateTimeFieldIndex] = atoi(dateTimeDigits);
+    dateTimeDigitIndex = 0;
+    dateTimeFieldIndex++;
+    uartTxWriteConst("\r\n", 2);
+
+    if (dateTimeFieldIndex < DATE_TIME_NUMBER_OF_FIELDS) {
+        uartTxWriteConst(dateTimePrompts[dateTimeFieldIndex].text,
+                         dateTimePrompts[dateTimeFieldIndex].length);
+        return;
+    }
+
+    struct tm rtcTime;
+    rtcTime.tm_year = dateTimeValues[DATE_TIME_FIELD_YEAR] - 1900;
+    rtcTime.tm_mon = dateTimeValues[DATE_TIME_FIELD_MONTH] - 1;
+    rtcTime.tm_mday = dateTimeValues[DATE_TIME_FIELD_DAY];
+    rtcTime.tm_hour = dateTimeValues[DATE_TIME_FIELD_HOUR];
+    rtcTime.tm_min = dateTimeValues[DATE_TIME_FIELD_MINUTES];
+    rtcTime.tm_sec = dateTimeValues[DATE_TIME_FIELD_SECONDS];
+    rtcTime.tm_isdst = -1;
+    set_time(mktime(&rtcTime));
+    uartTxWriteConst("Date and time has been set\r\n", 28);
+    uartCommandState = UART_COMMAND_IDLE;
 }
 
-float celsiusToFahrenheit(float tempInCelsiusDegrees)
+void availableCommands()
 {
-    return (tempInCelsiusDegrees * 9.0 / 5.0 + 32.0);
+    uartTxWriteConst("Available commands:\r\n", 21);
+    uartTxWriteConst("Press '1' to get the alarm state\r\n", 34);
+    uartTxWriteConst("Press '2' to get the gas detector state\r\n", 41);
+    uartTxWriteConst("Press '3' to get the over temperature detector state\r\n", 54);
+    uartTxWriteConst("Press '4' to enter the code sequence\r\n", 38);
+    uartTxWriteConst("Press '5' to enter a new code\r\n", 31);
+    uartTxWriteConst("Press 'f' or 'F' to get lm35 reading in Fahrenheit\r\n", 52);
+    uartTxWriteConst("Press 'c' or 'C' to get lm35 reading in Celsius\r\n", 49);
+    uartTxWriteConst("Press 'g' or 'G' to get mq2 reading in ppm per gas\r\n", 52);
+    uartTxWriteConst("Press 's' or 'S' to set the date and time\r\n", 43);
+    uartTxWriteConst("Press 't' or 'T' to get the date and time\r\n", 43);
+    uartTxWriteConst("Press 'e' or 'E' to get the stored events\r\n", 43);
+    uartTxWriteConst("Press 'j' or 'J' to get the last gas detections from the journal\r\n", 66);
+    uartTxWriteConst("Press 'x' or 'X' to export the last 24 hours of the journal\r\n", 61);
+    uartTxWriteConst("Press 'p' or 'P' to get the task timing statistics\r\n", 52);
+    uartTxWriteConst("Press 'b' or 'B' to start or stop binary telemetry streaming\r\n", 62);
+    uartTxWriteConst("Press 'm' or 'M' to get the memory footprint\r\n\r\n", 48);
 }
 
-void lm35ReadingsArrayInit()
+// False, and counted for the 'p' report, if the alarm thread's queue is full
+bool alarmCommandSend(alarmCommandType_t type, const char* keys)
 {
-    for (int i = 0; i < NUMBER_OF_AVG_SAMPLES; i++) {
-        lm35ReadingsArray[i] = 0;
+    alarmCommand_t command;
+
+    command.type = type;
+    for (int i = 0; i < alarmSystem_t::codeLength; i++) {
+        command.keys[i] = keys[i];
+    }
+    if (!alarmCommandQueue.push(command)) {
+        alarmCommandsDropped++;
+        return false;
     }
+    alarmThread.flags_set(ALARM_THREAD_FLAG_COMMAND);
+    return true;
 }
 
-void mq2ReadingsArrayInit()
+// Reports and journals everything published since the last call, whatever
+// its source. Journal writes may wait for the flash, so they stay out of the
+// alarm thread.
+void eventLogUpdate()
 {
-    for (int i = 0; i < NUMBER_OF_AVG_SAMPLES; i++) {
-        mq2ReadingsArray[i] = 0;
+    eventLogEntry_t event;
+    alarmSnapshot_t snapshot = alarmSnapshot.read();
+
+    while (eventLogRead(&eventLogReportCursor, &event)) {
+        eventJournalAppend(event.seconds, event.code, event.zone,
+                           snapshot.lm35Counts, snapshot.mq2Counts);
+        countLabel_t count = { event.count };
+        uartPrint(printString(eventLogCodeName(event.code)), count, "\r\n");
     }
 }
 
 void matrixKeypadInit()
 {
-    matrixKeypadState = MATRIX_KEYPAD_SCANNING;
-    for (int pinIndex = 0; pinIndex < KEYPAD_NUMBER_OF_COLS; pinIndex++) {
-        keypadColPins[pinIndex].mode(PullUp);
+    for (int pinIndex = 0; pinIndex < ALARM_CONFIG::keypadCols; pinIndex++) {
+        keypadColPins[pinIndex]->mode(PullUp);
+        keypadColPins[pinIndex]->fall(matrixKeypadColumnFall);
     }
+    matrixKeypadArm();
 }
 
 char matrixKeypadScan()
 {
-    for (int row = 0; row < KEYPAD_NUMBER_OF_ROWS; row++) {
-        for (int i = 0; i < KEYPAD_NUMBER_OF_ROWS; i++) {
+    for (int row = 0; row < ALARM_CONFIG::keypadRows; row++) {
+        for (int i = 0; i < ALARM_CONFIG::keypadRows; i++) {
             keypadRowPins[i] = ON;
         }
         keypadRowPins[row] = OFF;
-        for (int col = 0; col < KEYPAD_NUMBER_OF_COLS; col++) {
-            if (keypadColPins[col] == OFF) {
-                return matrixKeypadIndexToCharArray[row*KEYPAD_NUMBER_OF_ROWS + col];
+        for (int col = 0; col < ALARM_CONFIG::keypadCols; col++) {
+            if (keypadColPins[col]->read() == OFF) {
+                return alarmSystem_t::keypadKey(row, col);
             }
         }
     }
     return '\0';
 }
 
-char matrixKeypadUpdate()
+// Idle state: all rows low, so any key pulls its column low and raises a
+// falling-edge interrupt. Nothing runs until that happens.
+void matrixKeypadArm()
+{
+    for (int i = 0; i < ALARM_CONFIG::keypadRows; i++) {
+        keypadRowPins[i] = OFF;
+    }
+    matrixKeypadState = MATRIX_KEYPAD_SCANNING;
+    for (int pinIndex = 0; pinIndex < ALARM_CONFIG::keypadCols; pinIndex++) {
+        keypadColPins[pinIndex]->enable_irq();
+    }
+}
+
+void matrixKeypadColumnFall()
 {
-    char keyDetected = '\0';
-    char keyReleased = '\0';
+    if (matrixKeypadState != MATRIX_KEYPAD_SCANNING) {
+        return;
+    }
+    for (int pinIndex = 0; pinIndex < ALARM_CONFIG::keypadCols; pinIndex++) {
+        keypadColPins[pinIndex]->disable_irq();
+    }
+    matrixKeypadState = MATRIX_KEYPAD_DEBOUNCE;
+    // Taken by value: the chrono constructor would otherwise bind a
+    // reference to the static constexpr member, which has no definition
+    matrixKeypadTimeout.attach(matrixKeypadDebounceExpired,
+                               std::chrono::milliseconds((int)ALARM_CONFIG::debounceKeyTimeMs));
+}
+
+void matrixKeypadDebounceExpired()
+{
+    char keyDetected = matrixKeypadScan();
+    if (keyDetected == '\0') {
+        matrixKeypadArm();
+        return;
+    }
+    matrixKeypadLastKeyPressed = keyDetected;
+    matrixKeypadState = MATRIX_KEYPAD_KEY_HOLD_PRESSED;
+    matrixKeypadTimeout.attach(matrixKeypadReleasePoll,
+                               std::chrono::milliseconds(KEYPAD_RELEASE_POLL_MS));
+}
+
+void matrixKeypadReleasePoll()
+{
+    char keyDetected = matrixKeypadScan();
+    if (keyDetected == matrixKeypadLastKeyPressed) {
+        matrixKeypadTimeout.attach(matrixKeypadReleasePoll,
+                                   std::chrono::milliseconds(KEYPAD_RELEASE_POLL_MS));
+        return;
+    }
+
+    // Detection, debounce and release run in interrupt context; the alarm
+    // thread takes released keys from the queue
+    matrixKeypadQueue.push(matrixKeypadLastKeyPressed);
+    alarmThread.flags_set(ALARM_THREAD_FLAG_COMMAND);
+
+    // Another key is already held, so its column is low and will not fall
+    // again: debounce it directly, as if it had just been pressed
+    if (keyDetected != '\0') {
+        matrixKeypadState = MATRIX_KEYPAD_DEBOUNCE;
+        matrixKeypadTimeout.attach(matrixKeypadDebounceExpired,
+                                   std::chrono::milliseconds((int)ALARM_CONFIG::debounceKeyTimeMs));
+        return;
+    }
+    matrixKeypadArm();
+}
+
+void displayEventLog()
+{
+    eventLogEntry_t event;
+    uint32_t cursor = eventLogNewestCursor();
+
+    if (cursor - eventLogOldestCursor() > EVENT_DISPLAY_COUNT) {
+        cursor -= EVENT_DISPLAY_COUNT;
+    } else {
+        cursor = eventLogOldestCursor();
+    }
+
+    uartTxWriteConst("Recent Alarm Events:\r\n", 22);
+    while (eventLogRead(&cursor, &event)) {
+        zoneLabel_t label = { event.zone };
+        countLabel_t count = { event.count };
+        uartPrint("Event: ", printString(eventLogCodeName(event.code)), label, count,
+                  ", Time: ", printDateTime(event.seconds), "\n");
+    }
+    uartTxWriteConst("\r\n", 2);
+}
 
-    switch (matrixKeypadState) {
-    case MATRIX_KEYPAD_SCANNING:
-        keyDetected = matrixKeypadScan();
-        if (keyDetected != '\0') {
-            matrixKeypadLastKeyPressed = keyDetected;
-            accumulatedDebounceMatrixKeypadTime = 0;
-            matrixKeypadState = MATRIX_KEYPAD_DEBOUNCE;
+void displayJournalGasEvents()
+{
+    eventJournalRecord_t* records = consoleScratch.journalRecords;
+    int numberOfRecords = eventJournalLast(EVENT_GAS_DET_ON, records, EVENT_DISPLAY_COUNT);
+
+    uartTxWriteConst("Last Gas Detections:\r\n", 22);
+    for (int i = 0; i < numberOfRecords; i++) {
+        zoneLabel_t label = { records[i].zone };
+        uartPrint("Event: ", printString(eventLogCodeName(records[i].code)), label,
+                  ", MQ2: ", records[i].mq2Reading,
+                  ", Time: ", printDateTime(records[i].seconds), "\n");
+    }
+    uartTxWriteConst("\r\n", 2);
+}
+
+void journalExportStart()
+{
+    uint32_t now = (uint32_t)time(NULL);
+    uint32_t fromSeconds = now > JOURNAL_EXPORT_PERIOD_S ? now - JOURNAL_EXPORT_PERIOD_S : 0;
+
+    journalExportSequence = eventJournalSeek(fromSeconds);
+    journalExportActive = true;
+    uartTxWriteConst("sequence,seconds,event,lm35,mq2,zone\r\n", 38);
+}
+
+// Streams the export a few records at a time, only while the transmit queue
+// has room, so a long export neither blocks the loop nor drops lines.
+void journalExportUpdate()
+{
+    eventJournalRecord_t record;
+
+    while (journalExportActive && uartTxBytesPending() < JOURNAL_EXPORT_TX_THRESHOLD) {
+        if (journalExportSequence >= eventJournalNext()) {
+            uartTxWriteConst("End of journal export\r\n\r\n", 25);
+            journalExportActive = false;
+            break;
         }
-        break;
+        if (eventJournalRead(journalExportSequence, &record)) {
+            uartPrint(record.sequence, ",", record.seconds, ",",
+                      printString(eventLogCodeName(record.code)), ",",
+                      record.lm35Reading, ",", record.mq2Reading, ",", record.zone, "\r\n");
+        }
+        journalExportSequence++;
+    }
+}
 
-    case MATRIX_KEYPAD_DEBOUNCE:
-        if (accumulatedDebounceMatrixKeypadTime >= DEBOUNCE_KEY_TIME_MS) {
-            keyDetected = matrixKeypadScan();
-            if (keyDetected == matrixKeypadLastKeyPressed) {
-                matrixKeypadState = MATRIX_KEYPAD_KEY_HOLD_PRESSED;
-            } else {
-                matrixKeypadState = MATRIX_KEYPAD_SCANNING;
-            }
+// One packet per sensor block. A packet the transmit queue cannot take is
+// dropped whole, so the decoder sees a sequence gap rather than garbage.
+void telemetryUpdate()
+{
+    telemetryBlock_t telemetry;
+    uint8_t* packet = consoleScratch.telemetryPacket;
+
+    while (telemetryQueue.pop(&telemetry)) {
+        size_t length = telemetrySamplesEncode(telemetry.block.sequence, telemetry.state,
+                                               SENSOR_SAMPLER_CHANNELS, SENSOR_BLOCK_SIZE,
+                                               telemetry.averages,
+                                               &telemetry.block.frames[0][0],
+                                               packet, sizeof(consoleScratch.telemetryPacket));
+        uartTxWrite((const char*)packet, length);
+    }
+}
+
+void telemetryStreamingToggle()
+{
+    if (telemetryStreaming.load()) {
+        telemetryStreaming.store(false);
+        uartTxWriteConst("\r\nTelemetry streaming stopped\r\n\r\n", 33);
+    } else {
+        uartTxWriteConst("Telemetry streaming started\r\n", 29);
+        telemetryStreaming.store(true);
+    }
+}
+
+void profileReportStart()
+{
+#if PROFILER_ENABLED
+    profileReportProbe = -1;
+    profileReportActive = true;
+#else
+    uartTxWriteConst("Profiling is disabled in this build\r\n\r\n", 39);
+#endif
+}
+
+// One probe at a time while the transmit queue has room, as the journal
+// export does, and not in the middle of an export. The UART rate covers the
+// time since the previous report.
+void profileReportUpdate()
+{
+#if PROFILER_ENABLED
+    while (profileReportActive && !journalExportActive &&
+           uartTxBytesPending() < PROFILE_REPORT_TX_THRESHOLD) {
+        if (profileReportProbe < 0) {
+            uartTxWriteConst("Task timing (us):\r\n", 19);
+            profileReportProbe++;
+            continue;
+        }
+        if (profileReportProbe < PROFILER_NUMBER_OF_PROBES) {
+            profileReportProbePrint((profilerProbe_t)profileReportProbe);
+            profileReportProbe++;
+            continue;
         }
-        accumulatedDebounceMatrixKeypadTime += TIME_INCREMENT_MS;
-        break;
 
-    case MATRIX_KEYPAD_KEY_HOLD_PRESSED:
-        keyDetected = matrixKeypadScan();
-        if (keyDetected != matrixKeypadLastKeyPressed) {
-            if (keyDetected == '\0') {
-                keyReleased = matrixKeypadLastKeyPressed;
-            }
-            matrixKeypadState = MATRIX_KEYPAD_SCANNING;
+        Kernel::Clock::time_point now = Kernel::Clock::now();
+        uint32_t elapsedMs = (uint32_t)(now - profileReportLastTime).count();
+        uint32_t bytesSent = uartTxStatsGet()->bytesSent;
+        uint32_t bytesPerSecond = elapsedMs > 0 ?
+            (uint32_t)((uint64_t)(bytesSent - profileReportLastBytesSent) * 1000 / elapsedMs) : 0;
+
+        uartPrint("uart: ", bytesPerSecond, " bytes/s, ", bytesSent, " sent, ",
+                  uartTxStatsGet()->bytesDropped, " dropped\r\n",
+                  "sensor blocks: ", sensorSamplerStatsGet()->blocks, ", ",
+                  sensorSamplerStatsGet()->blocksOverrun, " overrun\r\n",
+                  "console messages: ", consoleMessagesDropped.load(std::memory_order_relaxed),
+                  " dropped\r\n",
+                  "alarm commands: ", alarmCommandsDropped, " dropped\r\n\r\n");
+        profileReportLastTime = now;
+        profileReportLastBytesSent = bytesSent;
+        profileReportActive = false;
+    }
+#endif
+}
+
+#if PROFILER_ENABLED
+void profileReportProbePrint(profilerProbe_t probe)
+{
+    const profilerProbeStats_t* stats = profilerStatsGet(probe);
+    uint32_t meanNs = stats->count > 0 ? (uint32_t)(stats->totalNs / stats->count) : 0;
+
+    uartPrint(printString(profilerProbeName(probe)), ": n=", stats->count,
+              " min=", printFixed(stats->count > 0 ? stats->minNs / 10 : 0, 2),
+              " mean=", printFixed(meanNs / 10, 2),
+              " max=", printFixed(stats->maxNs / 10, 2),
+              " overruns=", stats->overruns, "\r\n");
+
+    // Bucket b holds durations below 2^b ns
+    uartTxMessageBegin();
+    uartPrintPut("  histogram:");
+    for (int bucket = 0; bucket < PROFILER_HISTOGRAM_BUCKETS; bucket++) {
+        if (stats->histogram[bucket] == 0) {
+            continue;
+        }
+        if (bucket == PROFILER_HISTOGRAM_BUCKETS - 1) {
+            uartPrintPutAll(" >=", 1u << (bucket - 1), "ns:", stats->histogram[bucket]);
+        } else {
+            uartPrintPutAll(" <", 1u << bucket, "ns:", stats->histogram[bucket]);
         }
+    }
+    uartPrintPut("\r\n");
+    uartTxMessageEnd();
+}
+#endif
+
+void footprintReportStart()
+{
+    footprintReportLine = -1;
+    footprintReportTotal = 0;
+    footprintReportActive = true;
+}
+
+// Static RAM of the main structures, one per pass while the transmit queue
+// has room, then the totals and the thread stacks. The sizes follow the
+// layout mode of the build (memory_layout.h).
+void footprintReportUpdate()
+{
+    const char* name;
+    uint32_t bytes;
+
+    while (footprintReportActive && !journalExportActive && !profileReportActive &&
+           uartTxBytesPending() < FOOTPRINT_REPORT_TX_THRESHOLD) {
+        if (footprintReportLine < 0) {
+            uartPrint("Memory footprint (bytes), ",
+                      printString(COMPACT_LAYOUT ? "compact" : "default"), " layout:\r\n");
+            footprintReportLine++;
+            continue;
+        }
+        if (footprintEntryGet(footprintReportLine, &name, &bytes)) {
+            uartPrint(printString(name), ": ", bytes, "\r\n");
+            footprintReportTotal += bytes;
+            footprintReportLine++;
+            continue;
+        }
+
+        uartPrint("total listed: ", footprintReportTotal, "\r\n");
+#ifdef TOOLCHAIN_GCC_ARM
+        uartPrint("static RAM (data + bss): ",
+                  (uint32_t)((__data_end__ - __data_start__) + (__bss_end__ - __bss_start__)),
+                  "\r\n");
+#endif
+        footprintStackPrint(&alarmThread);
+        footprintStackPrint(&consoleThread);
+        uartTxWriteConst("\r\n", 2);
+        footprintReportActive = false;
+    }
+}
+
+// Report entry by index; false past the last one
+bool footprintEntryGet(int index, const char** name, uint32_t* bytes)
+{
+    switch (index) {
+    case 0:
+        *name = "alarm system";
+        *bytes = sizeof(alarmSystem);
         break;
 
-    default:
-        matrixKeypadInit();
+    case 1:
+        *name = "alarm snapshot";
+        *bytes = sizeof(alarmSnapshot);
+        break;
+
+    case 2:
+        *name = "alarm command queue";
+        *bytes = sizeof(alarmCommandQueue);
         break;
+
+    case 3:
+        *name = "keypad queue";
+        *bytes = sizeof(matrixKeypadQueue);
+        break;
+
+    case 4:
+        *name = "console message queue";
+        *bytes = sizeof(consoleMessageQueue);
+        break;
+
+    case 5:
+        *name = "telemetry queue";
+        *bytes = sizeof(telemetryQueue);
+        break;
+
+    case 6:
+        *name = "event coalescers";
+        *bytes = sizeof(alarmReportCoalescer) + sizeof(alarmEventCoalescer);
+        break;
+
+    case 7:
+        *name = "console scratch";
+        *bytes = sizeof(consoleScratch);
+        break;
+
+    case 8:
+        *name = "event log";
+        *bytes = eventLogFootprintBytes();
+        break;
+
+    case 9:
+        *name = "event journal";
+        *bytes = eventJournalFootprintBytes();
+        break;
+
+    case 10:
+        *name = "sensor sampler";
+        *bytes = sensorSamplerFootprintBytes();
+        break;
+
+    case 11:
+        *name = "uart tx";
+        *bytes = uartTxFootprintBytes();
+        break;
+
+    case 12:
+        *name = "uart rx";
+        *bytes = uartRxFootprintBytes();
+        break;
+
+    case 13:
+        *name = "warm start";
+        *bytes = sizeof(warmStartState) + warmStartFootprintBytes();
+        break;
+
+    case 14:
+        *name = "output patterns";
+        *bytes = outputPatternFootprintBytes();
+        break;
+
+#if PROFILER_ENABLED
+    case 15:
+        *name = "profiler";
+        *bytes = sizeof(profilerProbeStats_t) * PROFILER_NUMBER_OF_PROBES;
+        break;
+#endif
+
+    default:
+        return false;
     }
-    return keyReleased;
+    return true;
 }
 
-void displayEventLog()
+// The high-water mark needs stack statistics (platform.stack-stats-enabled);
+// without them, and on the host, only the size is known.
+void footprintStackPrint(const Thread* thread)
 {
-    char str[100];
-    uartUsb.write("Recent Alarm Events:\r\n", 22);
-    for (int i = 0; i < eventsIndex && i < EVENT_MAX_STORAGE; i++) {
-        sprintf(str, "Event: %s, Time: %s", 
-                arrayOfStoredEvents[i].typeOfEvent,
-                ctime(&arrayOfStoredEvents[i].seconds));
-        uartUsb.write(str, strlen(str));
+    if (thread->max_stack() > 0) {
+        uartPrint(printString(thread->get_name()), " stack: ", thread->stack_size(),
+                  ", max used: ", thread->max_stack(), "\r\n");
+    } else {
+        uartPrint(printString(thread->get_name()), " stack: ", thread->stack_size(), "\r\n");
     }
-    uartUsb.write("\r\n", 2);
-}
\ No newline at end of file
+}
@@ -0,0 +1,49 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _MEMORY_LAYOUT_H_
+#define _MEMORY_LAYOUT_H_
+
+// SRAM layout mode. COMPACT_LAYOUT=1 shrinks the event log, the UART
+// buffers and the thread queues to fit more channels and history in the
+// same SRAM, at the cost of less console type-ahead and in-RAM history.
+// Each buffer size can still be overridden on its own. Select it at build
+// time, e.g. in mbed_app.json:
+//   "macros": ["COMPACT_LAYOUT=1"]
+// The console 'm' command reports the resulting footprint.
+//
+// Each layout also sets RAM budgets, in bytes, for the buffers and state it
+// sizes. The owning modules check their sizes against them at compile time,
+// so a buffer grown past its budget breaks the build; raise the budget here
+// along with it.
+
+//=====[Declaration of public defines]=========================================
+
+#ifndef COMPACT_LAYOUT
+#define COMPACT_LAYOUT    0
+#endif
+
+#if COMPACT_LAYOUT
+#define MEMORY_LAYOUT_RAM_BUDGET      4096
+#define EVENT_LOG_RAM_BUDGET          1024
+#define UART_TX_RAM_BUDGET            1024
+#define UART_RX_RAM_BUDGET             128
+#define THREAD_QUEUES_RAM_BUDGET       384
+#else
+#define MEMORY_LAYOUT_RAM_BUDGET     16384
+#define EVENT_LOG_RAM_BUDGET         12800
+#define UART_TX_RAM_BUDGET            1280
+#define UART_RX_RAM_BUDGET             256
+#define THREAD_QUEUES_RAM_BUDGET       512
+#endif
+
+// Alarm system, its snapshot and warm-start copy, coalescers and scratch
+#define ALARM_STATE_RAM_BUDGET        1536
+
+#if EVENT_LOG_RAM_BUDGET + UART_TX_RAM_BUDGET + UART_RX_RAM_BUDGET + \
+    THREAD_QUEUES_RAM_BUDGET + ALARM_STATE_RAM_BUDGET > MEMORY_LAYOUT_RAM_BUDGET
+#error "RAM budgets exceed MEMORY_LAYOUT_RAM_BUDGET"
+#endif
+
+//=====[#include guards - end]=================================================
+
+#endif // _MEMORY_LAYOUT_H_
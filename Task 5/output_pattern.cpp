@@ -0,0 +1,138 @@
+//=====[Libraries]=============================================================
+
+#include <atomic>
+
+#include "mbed.h"
+
+#include "output_pattern.h"
+
+//=====[Declaration of private defines]========================================
+
+#define PATTERN_PACK(pattern)      (((uint32_t)(pattern).onMs << 16) | (pattern).offMs)
+#define PATTERN_ON_MS(packed)      ((uint16_t)((packed) >> 16))
+#define PATTERN_OFF_MS(packed)     ((uint16_t)((packed) & 0xFFFF))
+#define PATTERN_BLINKS(packed)     (PATTERN_ON_MS(packed) != 0 && PATTERN_OFF_MS(packed) != 0)
+
+//=====[Declaration of private data types]=====================================
+
+// While running is set the output's timer is armed and its interrupt owns
+// playing and level; otherwise the thread does.
+typedef struct outputChannel {
+    outputPatternWrite_t write;
+    std::atomic<uint32_t> requested;    // packed pattern, taken at the next period
+    std::atomic<bool> running;
+    uint32_t playing;                   // packed pattern
+    bool level;
+} outputChannel_t;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void outputLevelWrite(outputChannel_t* channel, bool on);
+static void outputTimerStart(int output, uint16_t ms);
+static void outputPatternStep(int output);
+
+// The timers take a plain function, so each output has its own handler
+template <int Output>
+static void outputPatternExpired()
+{
+    outputPatternStep(Output);
+}
+
+//=====[Declaration and initialization of private global variables]============
+
+static outputChannel_t channels[OUTPUT_PATTERN_MAX_OUTPUTS];
+static Timeout timers[OUTPUT_PATTERN_MAX_OUTPUTS];
+
+static void (*const expiredHandlers[OUTPUT_PATTERN_MAX_OUTPUTS])() = {
+    outputPatternExpired<0>,
+    outputPatternExpired<1>,
+    outputPatternExpired<2>,
+    outputPatternExpired<3>,
+};
+
+//=====[Implementations of public functions]===================================
+
+void outputPatternInit(int output, outputPatternWrite_t write)
+{
+    outputChannel_t* channel = &channels[output];
+
+    timers[output].detach();
+    channel->write = write;
+    channel->requested.store(0, std::memory_order_relaxed);
+    channel->running.store(false, std::memory_order_relaxed);
+    channel->playing = 0;
+    channel->level = false;
+    write(false);
+}
+
+void outputPatternSet(int output, outputPattern_t pattern)
+{
+    outputChannel_t* channel = &channels[output];
+    uint32_t packed = PATTERN_PACK(pattern);
+
+    if (channel->requested.load(std::memory_order_relaxed) == packed) {
+        return;
+    }
+    channel->requested.store(packed, std::memory_order_release);
+
+    if (PATTERN_BLINKS(packed)) {
+        if (channel->running.load(std::memory_order_acquire)) {
+            return;
+        }
+        channel->playing = packed;
+        outputLevelWrite(channel, true);
+        channel->running.store(true, std::memory_order_release);
+        outputTimerStart(output, PATTERN_ON_MS(packed));
+        return;
+    }
+
+    // On a single core the interrupt cannot run once the timer is detached
+    if (channel->running.load(std::memory_order_acquire)) {
+        timers[output].detach();
+        channel->running.store(false, std::memory_order_release);
+    }
+    channel->playing = packed;
+    outputLevelWrite(channel, PATTERN_ON_MS(packed) != 0);
+}
+
+uint32_t outputPatternFootprintBytes()
+{
+    return sizeof(channels) + sizeof(timers);
+}
+
+//=====[Implementations of private functions]==================================
+
+static void outputLevelWrite(outputChannel_t* channel, bool on)
+{
+    if (channel->level != on) {
+        channel->level = on;
+        channel->write(on);
+    }
+}
+
+static void outputTimerStart(int output, uint16_t ms)
+{
+    timers[output].attach(expiredHandlers[output], std::chrono::milliseconds(ms));
+}
+
+// Timer interrupt at the end of an on or off phase. The end of the off
+// phase is the period boundary, where a newly requested pattern starts.
+static void outputPatternStep(int output)
+{
+    outputChannel_t* channel = &channels[output];
+
+    if (channel->level) {
+        outputLevelWrite(channel, false);
+        outputTimerStart(output, PATTERN_OFF_MS(channel->playing));
+        return;
+    }
+
+    channel->playing = channel->requested.load(std::memory_order_acquire);
+    if (!PATTERN_BLINKS(channel->playing)) {
+        outputLevelWrite(channel, PATTERN_ON_MS(channel->playing) != 0);
+        channel->running.store(false, std::memory_order_release);
+        return;
+    }
+    outputLevelWrite(channel, true);
+    outputTimerStart(output, PATTERN_ON_MS(channel->playing));
+}
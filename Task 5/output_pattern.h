@@ -0,0 +1,62 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _OUTPUT_PATTERN_H_
+#define _OUTPUT_PATTERN_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+#define OUTPUT_PATTERN_MAX_OUTPUTS    4
+
+//=====[Declaration of public data types]======================================
+
+// On for onMs, then off for offMs, over and over. onMs 0 is steady off and
+// offMs 0 (with onMs above 0) steady on.
+typedef struct outputPattern {
+    uint16_t onMs;
+    uint16_t offMs;
+} outputPattern_t;
+
+// Drives an output to a level; called from thread or interrupt context
+typedef void (*outputPatternWrite_t)(bool on);
+
+//=====[Implementations of public functions]===================================
+
+inline outputPattern_t outputPatternSteady(bool on)
+{
+    outputPattern_t pattern = { (uint16_t)(on ? 1 : 0), 0 };
+    return pattern;
+}
+
+inline outputPattern_t outputPatternBlink(uint16_t halfPeriodMs)
+{
+    outputPattern_t pattern = { halfPeriodMs, halfPeriodMs };
+    return pattern;
+}
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+// Each output plays its pattern from a timer of its own, re-armed at every
+// edge, so a steady output costs nothing and a blinking one one interrupt
+// per edge, however long the threads take. write() is only called when the
+// level changes.
+
+// Registers an output and drives it off.
+void outputPatternInit(int output, outputPatternWrite_t write);
+
+// From one thread per output. A steady pattern takes effect at once. A
+// blinking pattern starts with its on phase, or, if the output is already
+// blinking, replaces the old pattern at the end of its current period.
+// Setting the pattern that is already playing or requested does nothing.
+void outputPatternSet(int output, outputPattern_t pattern);
+
+// Static RAM taken by the outputs and their timers, for the footprint
+// report
+uint32_t outputPatternFootprintBytes();
+
+//=====[#include guards - end]=================================================
+
+#endif // _OUTPUT_PATTERN_H_
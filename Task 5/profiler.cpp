@@ -0,0 +1,121 @@
+//=====[Libraries]=============================================================
+
+#include <string.h>
+
+#include "mbed.h"
+
+#include "profiler.h"
+
+#if PROFILER_ENABLED
+
+#ifdef MBED_HOST_BUILD
+#include <chrono>
+#endif
+
+//=====[Declaration and initialization of private global variables]============
+
+static profilerProbeStats_t probeStats[PROFILER_NUMBER_OF_PROBES];
+
+static const char* const probeNames[PROFILER_NUMBER_OF_PROBES] = {
+    "samplePeriod",
+    "alarmThread",
+    "alarmActivation",
+    "alarmDeactivation",
+    "consoleThread",
+    "uartTask",
+    "eventLog",
+};
+
+#ifndef MBED_HOST_BUILD
+static uint32_t cyclesPerMicrosecond = 1;
+#endif
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static int histogramBucket(uint32_t ns);
+
+//=====[Implementations of public functions]===================================
+
+void profilerInit()
+{
+    for (int probe = 0; probe < PROFILER_NUMBER_OF_PROBES; probe++) {
+        memset(&probeStats[probe], 0, sizeof(probeStats[probe]));
+        probeStats[probe].minNs = UINT32_MAX;
+        probeStats[probe].budgetNs = UINT32_MAX;
+    }
+
+#ifndef MBED_HOST_BUILD
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    cyclesPerMicrosecond = SystemCoreClock / 1000000;
+#endif
+}
+
+void profilerBudgetSet(profilerProbe_t probe, uint32_t budgetNs)
+{
+    probeStats[probe].budgetNs = budgetNs;
+}
+
+// CPU cycles on target, nanoseconds on host. Differences stay correct
+// across the 32-bit wrap (every 24 s at 180 MHz).
+uint32_t profilerTicks()
+{
+#ifdef MBED_HOST_BUILD
+    return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#else
+    return DWT->CYCCNT;
+#endif
+}
+
+void profilerRecordTicks(profilerProbe_t probe, uint32_t ticks)
+{
+#ifdef MBED_HOST_BUILD
+    profilerRecordNs(probe, ticks);
+#else
+    profilerRecordNs(probe, (uint32_t)((uint64_t)ticks * 1000 / cyclesPerMicrosecond));
+#endif
+}
+
+void profilerRecordNs(profilerProbe_t probe, uint32_t ns)
+{
+    profilerProbeStats_t* stats = &probeStats[probe];
+
+    stats->count++;
+    stats->totalNs += ns;
+    if (ns < stats->minNs) {
+        stats->minNs = ns;
+    }
+    if (ns > stats->maxNs) {
+        stats->maxNs = ns;
+    }
+    if (ns > stats->budgetNs) {
+        stats->overruns++;
+    }
+    stats->histogram[histogramBucket(ns)]++;
+}
+
+const profilerProbeStats_t* profilerStatsGet(profilerProbe_t probe)
+{
+    return &probeStats[probe];
+}
+
+const char* profilerProbeName(profilerProbe_t probe)
+{
+    if (probe >= PROFILER_NUMBER_OF_PROBES) {
+        return "unknown";
+    }
+    return probeNames[probe];
+}
+
+//=====[Implementations of private functions]==================================
+
+// Index of the highest set bit plus one, i.e. the smallest b with ns < 2^b
+static int histogramBucket(uint32_t ns)
+{
+    int bucket = ns == 0 ? 0 : 32 - __builtin_clz(ns);
+    return bucket < PROFILER_HISTOGRAM_BUCKETS ? bucket : PROFILER_HISTOGRAM_BUCKETS - 1;
+}
+
+#endif // PROFILER_ENABLED
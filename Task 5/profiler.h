@@ -0,0 +1,81 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+// On by default; release builds (NDEBUG) compile every probe out.
+#ifndef PROFILER_ENABLED
+#ifdef NDEBUG
+#define PROFILER_ENABLED    0
+#else
+#define PROFILER_ENABLED    1
+#endif
+#endif
+
+// Bucket b counts durations below 2^b ns (and at least 2^(b-1) ns); the
+// last bucket takes everything longer.
+#define PROFILER_HISTOGRAM_BUCKETS    32
+
+#if PROFILER_ENABLED
+// Times one statement, e.g. PROFILER_TIMED(PROFILER_PROBE_UART_TASK, uartTask());
+#define PROFILER_TIMED(probe, statement)                                   \
+    do {                                                                   \
+        uint32_t profilerStartTicks = profilerTicks();                     \
+        statement;                                                         \
+        profilerRecordTicks(probe, profilerTicks() - profilerStartTicks);  \
+    } while (0)
+#define PROFILER_RECORD_US(probe, us)    profilerRecordNs(probe, (uint32_t)(us) * 1000)
+#else
+#define PROFILER_TIMED(probe, statement)    do { statement; } while (0)
+#define PROFILER_RECORD_US(probe, us)       do { } while (0)
+#endif
+
+//=====[Declaration of public data types]======================================
+
+typedef enum {
+    PROFILER_PROBE_SAMPLE_PERIOD,
+    PROFILER_PROBE_ALARM_THREAD,
+    PROFILER_PROBE_ALARM_ACTIVATION,
+    PROFILER_PROBE_ALARM_DEACTIVATION,
+    PROFILER_PROBE_CONSOLE_THREAD,
+    PROFILER_PROBE_UART_TASK,
+    PROFILER_PROBE_EVENT_LOG,
+    PROFILER_NUMBER_OF_PROBES
+} profilerProbe_t;
+
+// A sample longer than budgetNs counts as an overrun.
+typedef struct profilerProbeStats {
+    uint32_t count;
+    uint32_t minNs;
+    uint32_t maxNs;
+    uint64_t totalNs;
+    uint32_t budgetNs;
+    uint32_t overruns;
+    uint32_t histogram[PROFILER_HISTOGRAM_BUCKETS];
+} profilerProbeStats_t;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+// Durations are measured with the DWT cycle counter on target and with the
+// host steady clock in the simulator, i.e. host time, not virtual time. They
+// are elapsed times, so they include any preemption by higher priorities.
+// Each probe must have a single writer (one thread or one ISR); readers may
+// see a sample half recorded, which is fine for diagnostics.
+void profilerInit();
+void profilerBudgetSet(profilerProbe_t probe, uint32_t budgetNs);
+uint32_t profilerTicks();
+void profilerRecordTicks(profilerProbe_t probe, uint32_t ticks);
+void profilerRecordNs(profilerProbe_t probe, uint32_t ns);
+
+const profilerProbeStats_t* profilerStatsGet(profilerProbe_t probe);
+const char* profilerProbeName(profilerProbe_t probe);
+
+//=====[#include guards - end]=================================================
+
+#endif // _PROFILER_H_
@@ -0,0 +1,215 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _SENSOR_BANK_H_
+#define _SENSOR_BANK_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public data types]======================================
+
+typedef enum {
+    SENSOR_KIND_TEMPERATURE,
+    SENSOR_KIND_GAS,
+    SENSOR_NUMBER_OF_KINDS
+} sensorKind_t;
+
+//=====[Declaration of public classes]=========================================
+
+// Moving averages and threshold detection for a bank of channels, stored as
+// structure of arrays. Samples arrive one frame (one sample per channel) at
+// a time; every per-channel step is a branch-free loop over contiguous
+// arrays with a compile-time trip count, which the compiler vectorizes on
+// the host and turns into a tight load/add/store loop on the M4.
+//
+// Averages and detector states are only recomputed by evaluate(), once per
+// block of frames, so the per-sample work is one add, one subtract and one
+// store per channel.
+//
+// Each detector has a hysteresis band and a dwell time: once above, a
+// channel only drops back when its average falls to the threshold minus
+// the hysteresis, and a new state is only taken once it has been seen in
+// more than dwell evaluations in a row. An average hovering at the threshold then
+// gives one transition instead of one per block.
+template <int Channels, int Window>
+class SensorBank {
+public:
+    static_assert(Channels > 0 && Window > 0, "bank must have channels and a window");
+    static_assert((uint64_t)Window * 65535 <= UINT32_MAX, "window sum must fit in 32 bits");
+
+    // Filter windows and detector states, for a warm start. Thresholds and
+    // channel kinds come from the configuration and are not part of it.
+    struct State {
+        uint16_t window[Window][Channels];
+        uint8_t above[Channels];
+        uint8_t pending[Channels];
+        int32_t windowIndex;
+    };
+
+    SensorBank()
+    {
+        for (int c = 0; c < Channels; c++) {
+            kinds[c] = SENSOR_KIND_TEMPERATURE;
+            onThresholds[c] = UINT16_MAX;
+            offThresholds[c] = UINT16_MAX;
+            dwells[c] = 0;
+        }
+        reset(0);
+    }
+
+    void reset(uint16_t value)
+    {
+        for (int i = 0; i < Window; i++) {
+            for (int c = 0; c < Channels; c++) {
+                window[i][c] = value;
+            }
+        }
+        for (int c = 0; c < Channels; c++) {
+            sums[c] = (uint32_t)value * Window;
+            averages[c] = value;
+            above[c] = 0;
+            rising[c] = 0;
+            pending[c] = 0;
+        }
+        windowIndex = 0;
+    }
+
+    // The channel goes above when its average exceeds thresholdCounts and
+    // back below when it is at or under thresholdCounts - hysteresisCounts.
+    void channelSet(int channel, sensorKind_t kind, uint16_t thresholdCounts,
+                    uint16_t hysteresisCounts = 0, uint8_t dwellEvaluations = 0)
+    {
+        kinds[channel] = (uint8_t)kind;
+        onThresholds[channel] = thresholdCounts;
+        offThresholds[channel] = hysteresisCounts < thresholdCounts ?
+                                 (uint16_t)(thresholdCounts - hysteresisCounts) : 0;
+        dwells[channel] = dwellEvaluations;
+    }
+
+    void stateSave(State* state) const
+    {
+        for (int i = 0; i < Window; i++) {
+            for (int c = 0; c < Channels; c++) {
+                state->window[i][c] = window[i][c];
+            }
+        }
+        for (int c = 0; c < Channels; c++) {
+            state->above[c] = above[c];
+            state->pending[c] = pending[c];
+        }
+        state->windowIndex = windowIndex;
+    }
+
+    // The sums and averages are rebuilt from the windows. Returns false,
+    // leaving the bank as it was, if the state is out of range.
+    bool stateRestore(const State& state)
+    {
+        if (state.windowIndex < 0 || state.windowIndex >= Window) {
+            return false;
+        }
+        for (int c = 0; c < Channels; c++) {
+            if (state.above[c] > 1 || state.pending[c] > dwells[c]) {
+                return false;
+            }
+        }
+        for (int c = 0; c < Channels; c++) {
+            sums[c] = 0;
+        }
+        for (int i = 0; i < Window; i++) {
+            for (int c = 0; c < Channels; c++) {
+                window[i][c] = state.window[i][c];
+                sums[c] += state.window[i][c];
+            }
+        }
+        for (int c = 0; c < Channels; c++) {
+            averages[c] = (uint16_t)(sums[c] / Window);
+            above[c] = state.above[c];
+            rising[c] = 0;
+            pending[c] = state.pending[c];
+        }
+        windowIndex = state.windowIndex;
+        return true;
+    }
+
+    // Adds one sample per channel and drops the oldest from every window.
+    void frameProcess(const uint16_t* __restrict frame)
+    {
+        uint16_t* __restrict oldest = window[windowIndex];
+        uint32_t* __restrict sum = sums;
+
+        for (int c = 0; c < Channels; c++) {
+            sum[c] += (uint32_t)frame[c] - oldest[c];
+            oldest[c] = frame[c];
+        }
+        windowIndex++;
+        if (windowIndex >= Window) {
+            windowIndex = 0;
+        }
+    }
+
+    // Recomputes the averages and the "average > threshold" states of all
+    // channels. Returns true if any channel went above its threshold.
+    bool evaluate()
+    {
+        uint8_t anyRising = 0;
+
+        for (int c = 0; c < Channels; c++) {
+            uint16_t average = (uint16_t)(sums[c] / Window);
+            uint16_t threshold = above[c] ? offThresholds[c] : onThresholds[c];
+            uint8_t isAbove = average > threshold;
+            uint8_t changing = isAbove ^ above[c];
+            uint8_t waiting = (uint8_t)(pending[c] + changing);
+            uint8_t settled = changing & (uint8_t)(waiting > dwells[c]);
+            averages[c] = average;
+            pending[c] = (uint8_t)(changing & (uint8_t)~settled) * waiting;
+            rising[c] = settled & isAbove;
+            above[c] ^= settled;
+            anyRising |= rising[c];
+        }
+        return anyRising != 0;
+    }
+
+    bool anyAbove(sensorKind_t kind) const
+    {
+        uint8_t any = 0;
+        for (int c = 0; c < Channels; c++) {
+            any |= above[c] & (uint8_t)(kinds[c] == kind);
+        }
+        return any != 0;
+    }
+
+    // Calls callback(channel) for each channel that went above its threshold
+    // in the last evaluate().
+    template <typename Callback>
+    void risingEdgesForEach(Callback callback) const
+    {
+        for (int c = 0; c < Channels; c++) {
+            if (rising[c]) {
+                callback(c);
+            }
+        }
+    }
+
+    uint16_t average(int channel) const { return averages[channel]; }
+    bool isAbove(int channel) const { return above[channel] != 0; }
+    static int channels() { return Channels; }
+    static int windowSize() { return Window; }
+
+private:
+    uint16_t window[Window][Channels];     // one row per frame
+    uint32_t sums[Channels];
+    uint16_t averages[Channels];
+    uint16_t onThresholds[Channels];
+    uint16_t offThresholds[Channels];
+    uint8_t kinds[Channels];
+    uint8_t above[Channels];
+    uint8_t rising[Channels];
+    uint8_t pending[Channels];             // evaluations the other state has held
+    uint8_t dwells[Channels];
+    int windowIndex;
+};
+
+//=====[#include guards - end]=================================================
+
+#endif // _SENSOR_BANK_H_
@@ -0,0 +1,189 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _SENSOR_CALIBRATION_H_
+#define _SENSOR_CALIBRATION_H_
+
+// Calibration curves turned into lookup tables at compile time. A table
+// holds the calibrated value every CALIBRATION_TABLE_STEP ADC counts and is
+// indexed by the top bits of a reading, so a conversion is one shift, two
+// loads and a linear interpolation: no logarithms or powers at run time.
+// The tables are constexpr and land in flash.
+//
+// The LM35 needs none: it is linear and sensor_scaling.h already converts
+// it with one Q16 multiply.
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+#include "sensor_scaling.h"
+
+//=====[Declaration of public defines]=========================================
+
+#define CALIBRATION_TABLE_SHIFT      8
+#define CALIBRATION_TABLE_STEP       (1 << CALIBRATION_TABLE_SHIFT)
+#define CALIBRATION_TABLE_ENTRIES    ((ADC_FULL_SCALE_COUNTS + 1) / CALIBRATION_TABLE_STEP + 1)
+
+// MQ2 board calibration. The module's load resistor is fed from the ADC
+// reference, so a reading gives Rs/RL = (full scale - counts) / counts.
+// R0 is taken from the reading in clean air, where the datasheet puts
+// Rs/R0 at 9.83. Override per board, e.g. in mbed_app.json macros.
+#ifndef MQ2_CLEAN_AIR_FRACTION
+#define MQ2_CLEAN_AIR_FRACTION       0.1     // of 3.3 V, after preheating
+#endif
+#define MQ2_CLEAN_AIR_RS_R0          9.83
+
+// The datasheet curves span 200 to 10000 ppm; readings past the top are
+// reported as the top.
+#define MQ2_PPM_MAX                  10000
+
+//=====[Declaration of public data types]======================================
+
+// MQ2 sensitivity curves, straight lines on the datasheet's log-log plot:
+// log10(Rs/R0) = log10RsR0 + slope * (log10(ppm) - log10Ppm)
+struct Mq2Lpg {
+    static constexpr double log10Ppm = 2.3;
+    static constexpr double log10RsR0 = 0.21;
+    static constexpr double slope = -0.47;
+};
+
+struct Mq2CarbonMonoxide {
+    static constexpr double log10Ppm = 2.3;
+    static constexpr double log10RsR0 = 0.72;
+    static constexpr double slope = -0.34;
+};
+
+struct Mq2Smoke {
+    static constexpr double log10Ppm = 2.3;
+    static constexpr double log10RsR0 = 0.53;
+    static constexpr double slope = -0.44;
+};
+
+//=====[Implementations of public functions]===================================
+
+// Compile-time only; the series are sized for double precision over the
+// ranges the curves use.
+constexpr double calibrationLn(double x)
+{
+    constexpr double ln2 = 0.69314718055994530942;
+    int exponent = 0;
+    while (x > 2.0) {
+        x /= 2.0;
+        exponent++;
+    }
+    while (x < 1.0) {
+        x *= 2.0;
+        exponent--;
+    }
+    // ln(x) = 2 atanh((x - 1) / (x + 1)), with the argument at most 1/3
+    double y = (x - 1.0) / (x + 1.0);
+    double term = y;
+    double sum = 0.0;
+    for (int n = 1; n < 64; n += 2) {
+        sum += term / n;
+        term *= y * y;
+    }
+    return 2.0 * sum + exponent * ln2;
+}
+
+constexpr double calibrationExp(double x)
+{
+    constexpr double ln2 = 0.69314718055994530942;
+    int exponent = 0;
+    while (x > ln2) {
+        x -= ln2;
+        exponent++;
+    }
+    while (x < 0.0) {
+        x += ln2;
+        exponent--;
+    }
+    double term = 1.0;
+    double sum = 1.0;
+    for (int n = 1; n < 24; n++) {
+        term *= x / n;
+        sum += term;
+    }
+    for (; exponent > 0; exponent--) {
+        sum *= 2.0;
+    }
+    for (; exponent < 0; exponent++) {
+        sum /= 2.0;
+    }
+    return sum;
+}
+
+//=====[Declaration of public classes]=========================================
+
+// Gas concentration in ppm for a reading, through the curve of Gas
+template <typename Gas>
+struct Mq2PpmCurve {
+    static constexpr double value(uint32_t counts)
+    {
+        constexpr double ln10 = 2.30258509299404568402;
+        constexpr double cleanAirRsRl = (1.0 - MQ2_CLEAN_AIR_FRACTION) / MQ2_CLEAN_AIR_FRACTION;
+
+        if (counts == 0) {
+            return 0.0;
+        }
+        if (counts >= ADC_FULL_SCALE_COUNTS) {
+            return MQ2_PPM_MAX;
+        }
+        double rsRl = (double)(ADC_FULL_SCALE_COUNTS - counts) / counts;
+        double log10RsR0 = calibrationLn(rsRl * MQ2_CLEAN_AIR_RS_R0 / cleanAirRsRl) / ln10;
+        double log10Ppm = Gas::log10Ppm + (log10RsR0 - Gas::log10RsR0) / Gas::slope;
+        if (log10Ppm * ln10 > calibrationLn(MQ2_PPM_MAX)) {
+            return MQ2_PPM_MAX;
+        }
+        return calibrationExp(log10Ppm * ln10);
+    }
+};
+
+// Curve::value(counts) sampled every CALIBRATION_TABLE_STEP counts and
+// rounded to integers.
+template <typename Curve>
+struct CalibrationTable {
+    uint32_t values[CALIBRATION_TABLE_ENTRIES];
+
+    constexpr CalibrationTable() : values()
+    {
+        for (int i = 0; i < CALIBRATION_TABLE_ENTRIES; i++) {
+            values[i] = (uint32_t)(Curve::value((uint32_t)i * CALIBRATION_TABLE_STEP) + 0.5);
+        }
+    }
+
+    constexpr bool isMonotonic() const
+    {
+        for (int i = 1; i < CALIBRATION_TABLE_ENTRIES; i++) {
+            if (values[i] < values[i - 1]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // For a non-decreasing table
+    uint32_t lookup(uint16_t counts) const
+    {
+        uint32_t index = counts >> CALIBRATION_TABLE_SHIFT;
+        uint32_t fraction = counts & (CALIBRATION_TABLE_STEP - 1);
+        uint32_t low = values[index];
+        return low + (((values[index + 1] - low) * fraction + CALIBRATION_TABLE_STEP / 2)
+                      >> CALIBRATION_TABLE_SHIFT);
+    }
+};
+
+//=====[Declaration of public constants]=======================================
+
+// e.g. mq2PpmTable<Mq2Lpg>.lookup(alarmSystem.mq2Counts())
+template <typename Gas>
+constexpr CalibrationTable<Mq2PpmCurve<Gas>> mq2PpmTable{};
+
+static_assert(mq2PpmTable<Mq2Lpg>.isMonotonic() &&
+              mq2PpmTable<Mq2CarbonMonoxide>.isMonotonic() &&
+              mq2PpmTable<Mq2Smoke>.isMonotonic(),
+              "MQ2 ppm tables must rise with the reading");
+
+//=====[#include guards - end]=================================================
+
+#endif // _SENSOR_CALIBRATION_H_
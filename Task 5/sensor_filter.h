@@ -0,0 +1,137 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _SENSOR_FILTER_H_
+#define _SENSOR_FILTER_H_
+
+// Single-channel filters. The firmware averages its channels in SensorBank
+// (sensor_bank.h) instead; these are kept for the host benchmarks, which
+// measure the sensor bank and the integer pipeline against them.
+
+//=====[Libraries]=============================================================
+
+#include <string.h>
+
+//=====[Declaration of public classes]=========================================
+
+// Moving average over the last N samples. The running sum is updated
+// incrementally (one sample in, one sample out) so each update costs the
+// same regardless of N. A compensated (Kahan) sum keeps float round-off from
+// accumulating over long runs; for integer types the compensation stays 0.
+template <typename T, int N, typename SumT = T>
+class MovingAverageFilter {
+public:
+    MovingAverageFilter() { reset(0); }
+
+    void reset(T value)
+    {
+        for (int i = 0; i < N; i++) {
+            samples[i] = value;
+        }
+        sum = (SumT)value * N;
+        compensation = 0;
+        sampleIndex = 0;
+    }
+
+    T update(T sample)
+    {
+        SumT delta = (SumT)sample - (SumT)samples[sampleIndex] - compensation;
+        SumT newSum = sum + delta;
+        compensation = (newSum - sum) - delta;
+        sum = newSum;
+
+        samples[sampleIndex] = sample;
+        sampleIndex++;
+        if (sampleIndex >= N) {
+            sampleIndex = 0;
+        }
+        return average();
+    }
+
+    T average() const { return (T)(sum / N); }
+    SumT total() const { return sum; }
+    static int windowSize() { return N; }
+
+private:
+    T samples[N];
+    SumT sum;
+    SumT compensation;
+    int sampleIndex;
+};
+
+// Exponential moving average with the same centre of mass as an N-sample
+// moving average (alpha = 2 / (N + 1)). Needs no sample storage.
+template <typename T, int N>
+class EmaFilter {
+public:
+    EmaFilter() { reset(0); }
+
+    void reset(T value) { output = value; }
+
+    T update(T sample)
+    {
+        output += (sample - output) * (T)2 / (T)(N + 1);
+        return output;
+    }
+
+    T average() const { return output; }
+
+private:
+    T output;
+};
+
+// Sliding median over the last N samples. A time-ordered ring and a sorted
+// copy are kept side by side; each update removes the oldest sample from the
+// sorted copy and inserts the new one, so the cost is one memmove of at most
+// N elements instead of a full sort. Intended for short spike-rejection
+// windows in front of a MovingAverageFilter.
+template <typename T, int N>
+class MedianFilter {
+public:
+    MedianFilter() { reset(0); }
+
+    void reset(T value)
+    {
+        for (int i = 0; i < N; i++) {
+            samples[i] = value;
+            sorted[i] = value;
+        }
+        sampleIndex = 0;
+    }
+
+    T update(T sample)
+    {
+        T oldest = samples[sampleIndex];
+        samples[sampleIndex] = sample;
+        sampleIndex++;
+        if (sampleIndex >= N) {
+            sampleIndex = 0;
+        }
+
+        int position = 0;
+        while (position < N - 1 && sorted[position] != oldest) {
+            position++;
+        }
+        memmove(&sorted[position], &sorted[position + 1],
+                (N - 1 - position) * sizeof(T));
+
+        position = N - 1;
+        while (position > 0 && sorted[position - 1] > sample) {
+            sorted[position] = sorted[position - 1];
+            position--;
+        }
+        sorted[position] = sample;
+
+        return average();
+    }
+
+    T average() const { return sorted[N / 2]; }
+
+private:
+    T samples[N];
+    T sorted[N];
+    int sampleIndex;
+};
+
+//=====[#include guards - end]=================================================
+
+#endif // _SENSOR_FILTER_H_
@@ -0,0 +1,106 @@
+//=====[Libraries]=============================================================
+
+#include "sensor_sampler.h"
+#include "profiler.h"
+
+//=====[Declaration of private defines]========================================
+
+#define SENSOR_SAMPLE_PERIOD_US    (1000000 / SENSOR_SAMPLE_RATE_HZ)
+
+//=====[Declaration and initialization of private global variables]============
+
+// The HAL analogin API is used directly because AnalogIn::read_u16() takes
+// a mutex, which is not allowed in interrupt context.
+static analogin_t channelAdcs[SENSOR_SAMPLER_CHANNELS];
+static Ticker samplerTicker;
+
+static sensorBlock_t blocks[SENSOR_BLOCK_COUNT];
+static volatile uint32_t blocksHead = 0;    // block being filled
+static volatile uint32_t blocksTail = 0;    // oldest completed block
+static int sampleIndex = 0;
+static uint32_t lastSampleUs = 0;
+static void (*blockReadyCallback)() = NULL;
+
+static sensorSamplerStats_t samplerStats;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void samplerTickerIsr();
+
+//=====[Implementations of public functions]===================================
+
+void sensorSamplerInit(const PinName* pins, void (*blockReady)())
+{
+    blockReadyCallback = blockReady;
+    for (int channel = 0; channel < SENSOR_SAMPLER_CHANNELS; channel++) {
+        analogin_init(&channelAdcs[channel], pins[channel]);
+    }
+    samplerStats.minIntervalUs = UINT32_MAX;
+    samplerTicker.attach(samplerTickerIsr,
+                         std::chrono::microseconds(SENSOR_SAMPLE_PERIOD_US));
+}
+
+bool sensorSamplerGetBlock(sensorBlock_t* block)
+{
+    bool available = false;
+
+    core_util_critical_section_enter();
+    if (blocksTail != blocksHead) {
+        *block = blocks[blocksTail % SENSOR_BLOCK_COUNT];
+        blocksTail++;
+        available = true;
+    }
+    core_util_critical_section_exit();
+    return available;
+}
+
+const sensorSamplerStats_t* sensorSamplerStatsGet()
+{
+    return &samplerStats;
+}
+
+uint32_t sensorSamplerFootprintBytes()
+{
+    return sizeof(channelAdcs) + sizeof(samplerTicker) + sizeof(blocks) + sizeof(samplerStats);
+}
+
+//=====[Implementations of private functions]==================================
+
+static void samplerTickerIsr()
+{
+    uint32_t nowUs = us_ticker_read();
+    sensorBlock_t* block = &blocks[blocksHead % SENSOR_BLOCK_COUNT];
+
+    if (samplerStats.samples > 0) {
+        uint32_t intervalUs = nowUs - lastSampleUs;
+        if (intervalUs < samplerStats.minIntervalUs) {
+            samplerStats.minIntervalUs = intervalUs;
+        }
+        if (intervalUs > samplerStats.maxIntervalUs) {
+            samplerStats.maxIntervalUs = intervalUs;
+        }
+        PROFILER_RECORD_US(PROFILER_PROBE_SAMPLE_PERIOD, intervalUs);
+    }
+    lastSampleUs = nowUs;
+
+    for (int channel = 0; channel < SENSOR_SAMPLER_CHANNELS; channel++) {
+        block->frames[sampleIndex][channel] = analogin_read_u16(&channelAdcs[channel]);
+    }
+    samplerStats.samples++;
+    sampleIndex++;
+    if (sampleIndex < SENSOR_BLOCK_SIZE) {
+        return;
+    }
+
+    block->sequence = samplerStats.blocks;
+    samplerStats.blocks++;
+    sampleIndex = 0;
+    blocksHead++;
+    if (blocksHead - blocksTail >= SENSOR_BLOCK_COUNT) {
+        blocksTail++;
+        samplerStats.blocksOverrun++;
+    }
+    if (blockReadyCallback != NULL) {
+        blockReadyCallback();
+    }
+}
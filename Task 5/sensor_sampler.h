@@ -0,0 +1,58 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _SENSOR_SAMPLER_H_
+#define _SENSOR_SAMPLER_H_
+
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+
+//=====[Declaration of public defines]=========================================
+
+#ifndef SENSOR_SAMPLE_RATE_HZ
+#define SENSOR_SAMPLE_RATE_HZ    100
+#endif
+#ifndef SENSOR_SAMPLER_CHANNELS
+#define SENSOR_SAMPLER_CHANNELS    2
+#endif
+#ifndef SENSOR_BLOCK_SIZE
+#define SENSOR_BLOCK_SIZE          5
+#endif
+#define SENSOR_BLOCK_COUNT         4     // must be a power of two
+
+#define SENSOR_BLOCK_PERIOD_MS   (SENSOR_BLOCK_SIZE * 1000 / SENSOR_SAMPLE_RATE_HZ)
+
+//=====[Declaration of public data types]======================================
+
+typedef struct sensorBlock {
+    uint32_t sequence;
+    uint16_t frames[SENSOR_BLOCK_SIZE][SENSOR_SAMPLER_CHANNELS];   // read_u16() scale
+} sensorBlock_t;
+
+typedef struct sensorSamplerStats {
+    uint32_t samples;
+    uint32_t blocks;
+    uint32_t blocksOverrun;
+    uint32_t minIntervalUs;
+    uint32_t maxIntervalUs;
+} sensorSamplerStats_t;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+// All channels are sampled together, one frame per tick, from a Ticker
+// interrupt at SENSOR_SAMPLE_RATE_HZ, independent of how long the control loop takes.
+// Samples are collected in blocks of SENSOR_BLOCK_SIZE; completed blocks
+// wait in a ring of SENSOR_BLOCK_COUNT until the loop takes them. If the
+// loop falls further behind, the oldest block is lost and counted.
+// blockReady, if not NULL, is called from the interrupt each time a block
+// completes, e.g. to wake the thread that consumes blocks.
+void sensorSamplerInit(const PinName* pins, void (*blockReady)());
+bool sensorSamplerGetBlock(sensorBlock_t* block);
+const sensorSamplerStats_t* sensorSamplerStatsGet();
+
+// Static RAM taken by the block ring and the sampler, for the footprint report
+uint32_t sensorSamplerFootprintBytes();
+
+//=====[#include guards - end]=================================================
+
+#endif // _SENSOR_SAMPLER_H_
@@ -0,0 +1,56 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _SENSOR_SCALING_H_
+#define _SENSOR_SCALING_H_
+
+// Integer conversions for the sensor pipeline. Samples stay in
+// AnalogIn::read_u16() counts (0..65535 for 0..3.3 V) end to end; thresholds
+// are converted to counts at compile time and temperatures are rendered in
+// hundredths of a degree through a Q16 fixed-point factor, so the hot path
+// needs neither the FPU nor software double arithmetic.
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+#define ADC_FULL_SCALE_COUNTS        65535
+#define LM35_FULL_SCALE_CENTI_C      33000    // 3.3 V at 10 mV/°C, in 0.01 °C
+
+//=====[Declaration of public constants]=======================================
+
+// 0.01 °C per ADC count in Q16, rounded to nearest
+static constexpr uint32_t LM35_CENTI_C_PER_COUNT_Q16 =
+    (uint32_t)(((uint64_t)LM35_FULL_SCALE_CENTI_C * 65536 + ADC_FULL_SCALE_COUNTS / 2)
+               / ADC_FULL_SCALE_COUNTS);
+
+//=====[Implementations of public functions]===================================
+
+// Highest count that is still at or below the given temperature, so that
+// "counts > lm35CountsAtCelsius(t)" matches "temperature > t".
+constexpr uint16_t lm35CountsAtCelsius(int celsius)
+{
+    return (uint16_t)((uint32_t)celsius * 100 * ADC_FULL_SCALE_COUNTS
+                      / LM35_FULL_SCALE_CENTI_C);
+}
+
+// Highest count at or below the given fraction of full scale.
+constexpr uint16_t adcCountsAtFraction(double fraction)
+{
+    return (uint16_t)(fraction * ADC_FULL_SCALE_COUNTS);
+}
+
+inline int32_t lm35CountsToCentiCelsius(uint16_t counts)
+{
+    return (int32_t)(((uint32_t)counts * LM35_CENTI_C_PER_COUNT_Q16 + 0x8000) >> 16);
+}
+
+inline int32_t centiCelsiusToCentiFahrenheit(int32_t centiCelsius)
+{
+    return centiCelsius * 9 / 5 + 3200;
+}
+
+//=====[#include guards - end]=================================================
+
+#endif // _SENSOR_SCALING_H_
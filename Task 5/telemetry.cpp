@@ -0,0 +1,233 @@
+//=====[Libraries]=============================================================
+
+#include "telemetry.h"
+#include "crc16.h"
+
+//=====[Declaration of private data types]=====================================
+
+// COBS encoder that frames bytes as they are produced. codeIndex is the
+// slot reserved for the length code of the block being filled.
+typedef struct cobsWriter {
+    uint8_t* out;
+    size_t capacity;
+    size_t length;
+    size_t codeIndex;
+    uint8_t code;
+    uint16_t crc;
+    bool overflow;
+} cobsWriter_t;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void cobsBegin(cobsWriter_t* writer, uint8_t* out, size_t capacity);
+static void cobsPutRaw(cobsWriter_t* writer, uint8_t byte);
+static void cobsPut(cobsWriter_t* writer, uint8_t byte);
+static void cobsPutVarint(cobsWriter_t* writer, uint32_t value);
+static size_t cobsEnd(cobsWriter_t* writer);
+static void cobsStore(cobsWriter_t* writer, size_t index, uint8_t byte);
+static size_t cobsDecode(const uint8_t* frame, size_t length, uint8_t* out, size_t capacity);
+static bool varintGet(const uint8_t* data, size_t length, size_t* position, uint32_t* value);
+static uint32_t zigzagEncode(int32_t value);
+static int32_t zigzagDecode(uint32_t value);
+
+//=====[Implementations of public functions]===================================
+
+size_t telemetrySamplesEncode(uint32_t sequence, uint8_t state, int channels, int frames,
+                              const uint16_t* averages, const uint16_t* samples,
+                              uint8_t* packet, size_t capacity)
+{
+    cobsWriter_t writer;
+
+    if (channels > TELEMETRY_MAX_CHANNELS || frames > TELEMETRY_MAX_FRAMES || frames < 1) {
+        return 0;
+    }
+
+    cobsBegin(&writer, packet, capacity);
+    cobsPut(&writer, TELEMETRY_PACKET_SAMPLES);
+    cobsPutVarint(&writer, sequence);
+    cobsPut(&writer, (uint8_t)channels);
+    cobsPut(&writer, (uint8_t)frames);
+    cobsPut(&writer, state);
+    for (int c = 0; c < channels; c++) {
+        cobsPutVarint(&writer, averages[c]);
+    }
+    for (int c = 0; c < channels; c++) {
+        cobsPutVarint(&writer, samples[c]);
+    }
+    for (int i = 1; i < frames; i++) {
+        for (int c = 0; c < channels; c++) {
+            int32_t delta = (int32_t)samples[i * channels + c] -
+                            (int32_t)samples[(i - 1) * channels + c];
+            cobsPutVarint(&writer, zigzagEncode(delta));
+        }
+    }
+
+    uint16_t crc = writer.crc;
+    cobsPut(&writer, (uint8_t)(crc & 0xFF));
+    cobsPut(&writer, (uint8_t)(crc >> 8));
+    return cobsEnd(&writer);
+}
+
+bool telemetryFrameDecode(const uint8_t* frame, size_t length, telemetrySamples_t* decoded)
+{
+    uint8_t payload[TELEMETRY_PAYLOAD_SIZE(TELEMETRY_MAX_CHANNELS, TELEMETRY_MAX_FRAMES)];
+    size_t payloadLength = cobsDecode(frame, length, payload, sizeof(payload));
+    size_t position = 0;
+    uint32_t value;
+
+    if (payloadLength < 3 ||
+        crc16Update(CRC16_INITIAL_VALUE, payload, payloadLength - 2) !=
+        (uint16_t)(payload[payloadLength - 2] | (payload[payloadLength - 1] << 8))) {
+        return false;
+    }
+    payloadLength -= 2;
+
+    if (payload[position++] != TELEMETRY_PACKET_SAMPLES ||
+        !varintGet(payload, payloadLength, &position, &decoded->sequence) ||
+        position + 3 > payloadLength) {
+        return false;
+    }
+    decoded->channels = payload[position++];
+    decoded->frames = payload[position++];
+    decoded->state = payload[position++];
+    if (decoded->channels > TELEMETRY_MAX_CHANNELS || decoded->frames > TELEMETRY_MAX_FRAMES ||
+        decoded->frames < 1) {
+        return false;
+    }
+
+    for (int c = 0; c < decoded->channels; c++) {
+        if (!varintGet(payload, payloadLength, &position, &value)) {
+            return false;
+        }
+        decoded->averages[c] = (uint16_t)value;
+    }
+    for (int i = 0; i < decoded->frames; i++) {
+        for (int c = 0; c < decoded->channels; c++) {
+            if (!varintGet(payload, payloadLength, &position, &value)) {
+                return false;
+            }
+            decoded->samples[i][c] = i == 0 ? (uint16_t)value :
+                (uint16_t)(decoded->samples[i - 1][c] + zigzagDecode(value));
+        }
+    }
+    return position == payloadLength;
+}
+
+//=====[Implementations of private functions]==================================
+
+static void cobsBegin(cobsWriter_t* writer, uint8_t* out, size_t capacity)
+{
+    writer->out = out;
+    writer->capacity = capacity;
+    writer->length = 0;
+    writer->overflow = false;
+    writer->crc = CRC16_INITIAL_VALUE;
+
+    cobsStore(writer, writer->length++, 0x00);
+    writer->codeIndex = writer->length++;
+    writer->code = 1;
+}
+
+static void cobsPutRaw(cobsWriter_t* writer, uint8_t byte)
+{
+    if (byte == 0x00) {
+        cobsStore(writer, writer->codeIndex, writer->code);
+        writer->codeIndex = writer->length++;
+        writer->code = 1;
+        return;
+    }
+    cobsStore(writer, writer->length++, byte);
+    writer->code++;
+    if (writer->code == 0xFF) {
+        cobsStore(writer, writer->codeIndex, writer->code);
+        writer->codeIndex = writer->length++;
+        writer->code = 1;
+    }
+}
+
+// Payload byte: covered by the CRC
+static void cobsPut(cobsWriter_t* writer, uint8_t byte)
+{
+    writer->crc = crc16Update(writer->crc, &byte, 1);
+    cobsPutRaw(writer, byte);
+}
+
+// Unsigned LEB128: 7 bits per byte, low group first, top bit set on all
+// but the last byte
+static void cobsPutVarint(cobsWriter_t* writer, uint32_t value)
+{
+    while (value >= 0x80) {
+        cobsPut(writer, (uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    cobsPut(writer, (uint8_t)value);
+}
+
+static size_t cobsEnd(cobsWriter_t* writer)
+{
+    cobsStore(writer, writer->codeIndex, writer->code);
+    cobsStore(writer, writer->length++, 0x00);
+    return writer->overflow ? 0 : writer->length;
+}
+
+static void cobsStore(cobsWriter_t* writer, size_t index, uint8_t byte)
+{
+    if (index >= writer->capacity) {
+        writer->overflow = true;
+        return;
+    }
+    writer->out[index] = byte;
+}
+
+static size_t cobsDecode(const uint8_t* frame, size_t length, uint8_t* out, size_t capacity)
+{
+    size_t read = 0;
+    size_t written = 0;
+
+    while (read < length) {
+        uint8_t code = frame[read++];
+        if (code == 0x00 || read + code - 1 > length) {
+            return 0;
+        }
+        for (int i = 1; i < code; i++) {
+            if (frame[read] == 0x00 || written >= capacity) {
+                return 0;
+            }
+            out[written++] = frame[read++];
+        }
+        if (code < 0xFF && read < length) {
+            if (written >= capacity) {
+                return 0;
+            }
+            out[written++] = 0x00;
+        }
+    }
+    return written;
+}
+
+static bool varintGet(const uint8_t* data, size_t length, size_t* position, uint32_t* value)
+{
+    uint32_t result = 0;
+
+    for (int shift = 0; shift < 35 && *position < length; shift += 7) {
+        uint8_t byte = data[(*position)++];
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Maps small negative and positive deltas to small unsigned values:
+// 0, -1, 1, -2, 2 ... become 0, 1, 2, 3, 4 ...
+static uint32_t zigzagEncode(int32_t value)
+{
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+static int32_t zigzagDecode(uint32_t value)
+{
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
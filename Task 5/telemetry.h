@@ -0,0 +1,69 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _TELEMETRY_H_
+#define _TELEMETRY_H_
+
+//=====[Libraries]=============================================================
+
+#include <stddef.h>
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+#define TELEMETRY_MAX_CHANNELS    8
+#define TELEMETRY_MAX_FRAMES     32
+
+// Largest encoded packet for a block: header, averages and samples at full
+// varint width, CRC, COBS overhead and both delimiters.
+#define TELEMETRY_PAYLOAD_SIZE(channels, frames)    (9 + 3 * (channels) * ((frames) + 1) + 2)
+#define TELEMETRY_PACKET_SIZE(channels, frames)                             \
+    (TELEMETRY_PAYLOAD_SIZE(channels, frames) +                             \
+     TELEMETRY_PAYLOAD_SIZE(channels, frames) / 254 + 1 + 2)
+
+#define TELEMETRY_PACKET_SAMPLES    0x01
+
+// State bits
+#define TELEMETRY_STATE_ALARM_ON     0x01
+#define TELEMETRY_STATE_GAS          0x02
+#define TELEMETRY_STATE_OVER_TEMP    0x04
+#define TELEMETRY_STATE_BLOCKED      0x08
+
+//=====[Declaration of public data types]======================================
+
+// One block of samples, frames x channels in ADC counts, with the filtered
+// averages and alarm state at the time it was processed.
+typedef struct telemetrySamples {
+    uint32_t sequence;
+    uint8_t state;
+    uint8_t channels;
+    uint8_t frames;
+    uint16_t averages[TELEMETRY_MAX_CHANNELS];
+    uint16_t samples[TELEMETRY_MAX_FRAMES][TELEMETRY_MAX_CHANNELS];
+} telemetrySamples_t;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+// Packet layout, before framing:
+//   type (1 byte), sequence (varint), channels, frames, state (1 byte each),
+//   averages (varint per channel), first frame (varint per channel),
+//   following frames (zigzag varint delta from the previous frame, per
+//   channel), CRC-16/CCITT of all of the above (2 bytes, little endian).
+// The packet is COBS encoded and sent between two 0x00 delimiters, so a
+// receiver resynchronizes at the next zero after noise or console text.
+// Each packet starts from absolute values and decodes on its own.
+//
+// samples points to frames rows of channels values. The packet is framed as
+// it is built, with no intermediate buffer; TELEMETRY_PACKET_SIZE() bytes
+// are always enough. Returns the number of bytes written to packet, or 0 if
+// capacity is too small.
+size_t telemetrySamplesEncode(uint32_t sequence, uint8_t state, int channels, int frames,
+                              const uint16_t* averages, const uint16_t* samples,
+                              uint8_t* packet, size_t capacity);
+
+// Decodes one COBS frame, without its delimiters. Returns false for a frame
+// that fails COBS, CRC or layout checks, e.g. console text.
+bool telemetryFrameDecode(const uint8_t* frame, size_t length, telemetrySamples_t* decoded);
+
+//=====[#include guards - end]=================================================
+
+#endif // _TELEMETRY_H_
@@ -0,0 +1,147 @@
+//=====[Libraries]=============================================================
+
+#include <string.h>
+
+#include "uart_print.h"
+
+//=====[Declaration of private defines]========================================
+
+#define SECONDS_PER_DAY        86400
+#define DAYS_1970_TO_0000   719468   // Days from 0000-03-01 to 1970-01-01
+
+//=====[Declaration and initialization of private global variables]============
+
+static const char weekdayNames[] = "SunMonTueWedThuFriSat";
+static const char monthNames[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+static char dateTimeText[UART_PRINT_DATE_TIME_LENGTH + 1] = "";
+static uint32_t dateTimeSeconds = 0;
+static uint32_t dateTimeDay = UINT32_MAX;
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void dateTimeTextDateUpdate(uint32_t day);
+static void dateTimeTextClockUpdate(uint32_t secondOfDay);
+static void twoDigitsWrite(char* destination, uint32_t value, char leadingZero);
+
+//=====[Implementations of public functions]===================================
+
+const char* uartPrintDateTimeText(uint32_t seconds)
+{
+    uint32_t day = seconds / SECONDS_PER_DAY;
+
+    if (day != dateTimeDay) {
+        dateTimeTextDateUpdate(day);
+        dateTimeTextClockUpdate(seconds % SECONDS_PER_DAY);
+        dateTimeDay = day;
+        dateTimeSeconds = seconds;
+    } else if (seconds != dateTimeSeconds) {
+        dateTimeTextClockUpdate(seconds % SECONDS_PER_DAY);
+        dateTimeSeconds = seconds;
+    }
+    return dateTimeText;
+}
+
+void uartPrintPut(uartPrintString_t argument)
+{
+    const char* str = argument.str;
+    while (*str != '\0') {
+        uartTxMessagePutChar(*str);
+        str++;
+    }
+}
+
+void uartPrintPut(uartPrintFixed_t argument)
+{
+    uint32_t scale = 1;
+
+    for (int i = 0; i < argument.decimals; i++) {
+        scale *= 10;
+    }
+    if (argument.negative) {
+        uartTxMessagePutChar('-');
+    }
+    uartPrintPutUnsigned(argument.magnitude / scale);
+    if (argument.decimals > 0) {
+        uint32_t fraction = argument.magnitude % scale;
+        uartTxMessagePutChar('.');
+        for (scale /= 10; scale > 0; scale /= 10) {
+            uartTxMessagePutChar('0' + fraction / scale);
+            fraction %= scale;
+        }
+    }
+}
+
+void uartPrintPut(uartPrintDateTime_t argument)
+{
+    uartTxMessagePut(uartPrintDateTimeText(argument.seconds), UART_PRINT_DATE_TIME_LENGTH);
+}
+
+void uartPrintPutUnsigned(uint32_t value)
+{
+    char digits[10];
+    int count = 0;
+
+    do {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+    while (count > 0) {
+        uartTxMessagePutChar(digits[--count]);
+    }
+}
+
+void uartPrintPutSigned(int32_t value)
+{
+    if (value < 0) {
+        uartTxMessagePutChar('-');
+        uartPrintPutUnsigned(0u - (uint32_t)value);
+    } else {
+        uartPrintPutUnsigned((uint32_t)value);
+    }
+}
+
+//=====[Implementations of private functions]==================================
+
+// Civil date from a day count, after H. Hinnant's days_from_civil inverse.
+// Eras are 400-year cycles starting on March 1st, so leap days fall last.
+static void dateTimeTextDateUpdate(uint32_t day)
+{
+    uint32_t days = day + DAYS_1970_TO_0000;
+    uint32_t era = days / 146097;
+    uint32_t dayOfEra = days - era * 146097;
+    uint32_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 -
+                          dayOfEra / 146096) / 365;
+    uint32_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    uint32_t shiftedMonth = (5 * dayOfYear + 2) / 153;
+    uint32_t dayOfMonth = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+    uint32_t month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+    uint32_t year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+    uint32_t weekday = (day + 4) % 7;   // 1970-01-01 was a Thursday
+
+    memcpy(&dateTimeText[0], &weekdayNames[weekday * 3], 3);
+    dateTimeText[3] = ' ';
+    memcpy(&dateTimeText[4], &monthNames[(month - 1) * 3], 3);
+    dateTimeText[7] = ' ';
+    twoDigitsWrite(&dateTimeText[8], dayOfMonth, ' ');
+    dateTimeText[10] = ' ';
+    dateTimeText[13] = ':';
+    dateTimeText[16] = ':';
+    dateTimeText[19] = ' ';
+    twoDigitsWrite(&dateTimeText[20], (year / 100) % 100, '0');
+    twoDigitsWrite(&dateTimeText[22], year % 100, '0');
+    dateTimeText[UART_PRINT_DATE_TIME_LENGTH] = '\0';
+}
+
+static void dateTimeTextClockUpdate(uint32_t secondOfDay)
+{
+    twoDigitsWrite(&dateTimeText[11], secondOfDay / 3600, '0');
+    twoDigitsWrite(&dateTimeText[14], (secondOfDay / 60) % 60, '0');
+    twoDigitsWrite(&dateTimeText[17], secondOfDay % 60, '0');
+}
+
+static void twoDigitsWrite(char* destination, uint32_t value, char leadingZero)
+{
+    destination[0] = value >= 10 ? '0' + value / 10 : leadingZero;
+    destination[1] = '0' + value % 10;
+}
@@ -0,0 +1,108 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _UART_PRINT_H_
+#define _UART_PRINT_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+#include <type_traits>
+
+#include "uart_tx.h"
+
+//=====[Declaration of public defines]=========================================
+
+// Length of the cached date and time text, in ctime() layout without the
+// trailing newline: "Thu Jan  1 00:00:00 1970"
+#define UART_PRINT_DATE_TIME_LENGTH    24
+
+//=====[Declaration of public data types]======================================
+
+// Argument wrappers for uartPrint(). String literals, single chars and
+// integers are passed as they are; anything else needs one of these.
+typedef struct uartPrintString {
+    const char* str;
+} uartPrintString_t;
+
+typedef struct uartPrintFixed {
+    uint32_t magnitude;
+    bool negative;
+    uint8_t decimals;
+} uartPrintFixed_t;
+
+typedef struct uartPrintDateTime {
+    uint32_t seconds;
+} uartPrintDateTime_t;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+inline uartPrintString_t printString(const char* str) { return {str}; }
+inline uartPrintFixed_t printFixed(int32_t value, uint8_t decimals)
+{
+    return {value < 0 ? 0u - (uint32_t)value : (uint32_t)value, value < 0, decimals};
+}
+inline uartPrintFixed_t printFixed(uint32_t value, uint8_t decimals) { return {value, false, decimals}; }
+inline uartPrintDateTime_t printDateTime(uint32_t seconds) { return {seconds}; }
+
+// Returns the date and time text for the given seconds. The text is cached:
+// repeated calls within the same second return it as is, and within the same
+// day only the clock digits are rewritten.
+const char* uartPrintDateTimeText(uint32_t seconds);
+
+void uartPrintPut(uartPrintString_t argument);
+void uartPrintPut(uartPrintFixed_t argument);
+void uartPrintPut(uartPrintDateTime_t argument);
+void uartPrintPutUnsigned(uint32_t value);
+void uartPrintPutSigned(int32_t value);
+
+inline void uartPrintPut(char character)
+{
+    uartTxMessagePutChar(character);
+}
+
+template <size_t N>
+inline void uartPrintPut(const char (&literal)[N])
+{
+    uartTxMessagePut(literal, N - 1);
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value &&
+                               !std::is_same<T, bool>::value>::type
+uartPrintPut(T value)
+{
+    uartPrintPutUnsigned((uint32_t)value);
+}
+
+template <typename T>
+inline typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value &&
+                               !std::is_same<T, char>::value>::type
+uartPrintPut(T value)
+{
+    uartPrintPutSigned((int32_t)value);
+}
+
+inline void uartPrintPutAll() {}
+
+template <typename First, typename... Rest>
+inline void uartPrintPutAll(const First& first, const Rest&... rest)
+{
+    uartPrintPut(first);
+    uartPrintPutAll(rest...);
+}
+
+// Formats the arguments straight into the UART transmit buffer as one
+// message. The message layout is the argument list itself, so it is checked
+// when compiled: an argument with no matching uartPrintPut() (a float, a bare
+// char pointer) does not build. Returns false if the message was dropped.
+template <typename... Args>
+inline bool uartPrint(const Args&... args)
+{
+    uartTxMessageBegin();
+    uartPrintPutAll(args...);
+    return uartTxMessageEnd();
+}
+
+//=====[#include guards - end]=================================================
+
+#endif // _UART_PRINT_H_
@@ -0,0 +1,66 @@
+//=====[Libraries]=============================================================
+
+#include "uart_rx.h"
+
+//=====[Declaration and initialization of private global variables]============
+
+static UnbufferedSerial* uartRxSerial = NULL;
+
+static char rxBuffer[UART_RX_BUFFER_SIZE];
+static volatile uint32_t rxBufferHead = 0;
+static volatile uint32_t rxBufferTail = 0;
+static volatile uint32_t rxOverruns = 0;
+
+static_assert(sizeof(rxBuffer) <= UART_RX_RAM_BUDGET,
+              "uart rx buffer exceeds UART_RX_RAM_BUDGET for this layout");
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static void uartRxIrqHandler();
+
+//=====[Implementations of public functions]===================================
+
+void uartRxInit(UnbufferedSerial* serial)
+{
+    uartRxSerial = serial;
+    uartRxSerial->attach(uartRxIrqHandler, SerialBase::RxIrq);
+}
+
+bool uartRxRead(char* receivedChar)
+{
+    uint32_t tail = rxBufferTail;
+    if (tail == rxBufferHead) {
+        return false;
+    }
+    *receivedChar = rxBuffer[tail];
+    rxBufferTail = (tail + 1) % UART_RX_BUFFER_SIZE;
+    return true;
+}
+
+uint32_t uartRxOverruns()
+{
+    return rxOverruns;
+}
+
+uint32_t uartRxFootprintBytes()
+{
+    return sizeof(rxBuffer);
+}
+
+//=====[Implementations of private functions]==================================
+
+static void uartRxIrqHandler()
+{
+    char receivedChar;
+    while (uartRxSerial->readable()) {
+        uartRxSerial->read(&receivedChar, 1);
+        uint32_t head = rxBufferHead;
+        uint32_t nextHead = (head + 1) % UART_RX_BUFFER_SIZE;
+        if (nextHead == rxBufferTail) {
+            rxOverruns++;
+            continue;
+        }
+        rxBuffer[head] = receivedChar;
+        rxBufferHead = nextHead;
+    }
+}
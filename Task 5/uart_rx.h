@@ -0,0 +1,34 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _UART_RX_H_
+#define _UART_RX_H_
+
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include "memory_layout.h"
+
+//=====[Declaration of public defines]=========================================
+
+#ifndef UART_RX_BUFFER_SIZE
+#if COMPACT_LAYOUT
+#define UART_RX_BUFFER_SIZE    64
+#else
+#define UART_RX_BUFFER_SIZE    128
+#endif
+#endif
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+// Bytes are moved from the serial port into a ring buffer by the RX
+// interrupt, so type-ahead is kept while the control loop is busy.
+void uartRxInit(UnbufferedSerial* serial);
+bool uartRxRead(char* receivedChar);
+uint32_t uartRxOverruns();
+
+// Static RAM taken by the receive buffer, for the footprint report
+uint32_t uartRxFootprintBytes();
+
+//=====[#include guards - end]=================================================
+
+#endif // _UART_RX_H_
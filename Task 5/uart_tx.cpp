@@ -0,0 +1,197 @@
+//=====[Libraries]=============================================================
+
+#include "uart_tx.h"
+
+//=====[Declaration of private data types]=====================================
+
+typedef struct uartTxMessage {
+    const char* data;       // NULL when the bytes are in txBuffer
+    uint16_t length;
+} uartTxMessage_t;
+
+//=====[Declaration and initialization of private global variables]============
+
+static UnbufferedSerial* uartTxSerial = NULL;
+
+// Single producer (control loop) and single consumer (TX interrupt). Each
+// side only advances its own index.
+static uartTxMessage_t txMessages[UART_TX_MAX_MESSAGES];
+static volatile uint32_t txMessagesHead = 0;
+static volatile uint32_t txMessagesTail = 0;
+static uint16_t txMessageOffset = 0;
+
+static char txBuffer[UART_TX_BUFFER_SIZE];
+static volatile uint32_t txBufferHead = 0;
+static volatile uint32_t txBufferTail = 0;
+
+static volatile uint32_t txBytesPending = 0;
+static volatile bool txActive = false;
+
+static uartTxStats_t txStats;
+
+// Message being assembled by the producer, not yet visible to the interrupt
+static uint32_t txAssemblyHead = 0;
+static uint32_t txAssemblyLength = 0;
+static bool txAssemblyOverflow = false;
+
+static constexpr uint32_t uartTxRamBytes = sizeof(txMessages) + sizeof(txBuffer) + sizeof(txStats);
+static_assert(uartTxRamBytes <= UART_TX_RAM_BUDGET,
+              "uart tx buffers exceed UART_TX_RAM_BUDGET for this layout");
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static bool uartTxEnqueue(const char* str, size_t length);
+static void uartTxStart();
+static void uartTxIrqHandler();
+
+//=====[Implementations of public functions]===================================
+
+void uartTxInit(UnbufferedSerial* serial)
+{
+    uartTxSerial = serial;
+}
+
+bool uartTxWriteConst(const char* str, size_t length)
+{
+    return uartTxEnqueue(str, length);
+}
+
+bool uartTxWrite(const char* data, size_t length)
+{
+    uartTxMessageBegin();
+    uartTxMessagePut(data, length);
+    return uartTxMessageEnd();
+}
+
+void uartTxMessageBegin()
+{
+    txAssemblyHead = txBufferHead;
+    txAssemblyLength = 0;
+    txAssemblyOverflow = false;
+}
+
+void uartTxMessagePut(const char* data, size_t length)
+{
+    for (size_t i = 0; i < length; i++) {
+        uartTxMessagePutChar(data[i]);
+    }
+}
+
+void uartTxMessagePutChar(char byte)
+{
+    uint32_t bufferUsed = (txAssemblyHead - txBufferTail + UART_TX_BUFFER_SIZE)
+                          % UART_TX_BUFFER_SIZE;
+
+    if (txAssemblyOverflow || bufferUsed + 1 >= UART_TX_BUFFER_SIZE) {
+        txAssemblyOverflow = true;
+        txAssemblyLength++;
+        return;
+    }
+    txBuffer[txAssemblyHead] = byte;
+    txAssemblyHead = (txAssemblyHead + 1) % UART_TX_BUFFER_SIZE;
+    txAssemblyLength++;
+}
+
+bool uartTxMessageEnd()
+{
+    if (txAssemblyOverflow) {
+        txStats.messagesDropped++;
+        txStats.bytesDropped += txAssemblyLength;
+        return false;
+    }
+    return uartTxEnqueue(NULL, txAssemblyLength);
+}
+
+size_t uartTxBytesPending()
+{
+    return txBytesPending;
+}
+
+const uartTxStats_t* uartTxStatsGet()
+{
+    return &txStats;
+}
+
+uint32_t uartTxFootprintBytes()
+{
+    return uartTxRamBytes;
+}
+
+//=====[Implementations of private functions]==================================
+
+// Publishes a message descriptor. For copied messages (str == NULL) the
+// bytes are already in txBuffer up to txAssemblyHead.
+static bool uartTxEnqueue(const char* str, size_t length)
+{
+    uint32_t head = txMessagesHead;
+    uint32_t nextHead = (head + 1) % UART_TX_MAX_MESSAGES;
+
+    if (length == 0) {
+        return true;
+    }
+    if (nextHead == txMessagesTail || length > UINT16_MAX) {
+        txStats.messagesDropped++;
+        txStats.bytesDropped += length;
+        return false;
+    }
+
+    if (str == NULL) {
+        txBufferHead = txAssemblyHead;
+    }
+    txMessages[head].data = str;
+    txMessages[head].length = (uint16_t)length;
+
+    core_util_critical_section_enter();
+    txMessagesHead = nextHead;
+    txBytesPending += length;
+    if (txBytesPending > txStats.maxBytesPending) {
+        txStats.maxBytesPending = txBytesPending;
+    }
+    core_util_critical_section_exit();
+    txStats.bytesQueued += length;
+
+    uartTxStart();
+    return true;
+}
+
+static void uartTxStart()
+{
+    core_util_critical_section_enter();
+    if (!txActive && uartTxSerial != NULL) {
+        txActive = true;
+        uartTxSerial->attach(uartTxIrqHandler, SerialBase::TxIrq);
+    }
+    core_util_critical_section_exit();
+}
+
+// Refills the transmit register until it is busy; disables itself once the
+// queue is empty.
+static void uartTxIrqHandler()
+{
+    while (uartTxSerial->writable()) {
+        uint32_t tail = txMessagesTail;
+        if (tail == txMessagesHead) {
+            uartTxSerial->attach(nullptr, SerialBase::TxIrq);
+            txActive = false;
+            return;
+        }
+
+        uartTxMessage_t* message = &txMessages[tail];
+        char byte;
+        if (message->data != NULL) {
+            byte = message->data[txMessageOffset];
+        } else {
+            byte = txBuffer[txBufferTail];
+            txBufferTail = (txBufferTail + 1) % UART_TX_BUFFER_SIZE;
+        }
+        uartTxSerial->write(&byte, 1);
+        txBytesPending--;
+        txStats.bytesSent++;
+
+        txMessageOffset++;
+        if (txMessageOffset >= message->length) {
+            txMessageOffset = 0;
+            txMessagesTail = (tail + 1) % UART_TX_MAX_MESSAGES;
+        }
+    }
+}
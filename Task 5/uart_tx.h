@@ -0,0 +1,63 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _UART_TX_H_
+#define _UART_TX_H_
+
+//=====[Libraries]=============================================================
+
+#include "mbed.h"
+#include "memory_layout.h"
+
+//=====[Declaration of public defines]=========================================
+
+#define UART_TX_MAX_MESSAGES    32
+
+#ifndef UART_TX_BUFFER_SIZE
+#if COMPACT_LAYOUT
+#define UART_TX_BUFFER_SIZE    256
+#else
+#define UART_TX_BUFFER_SIZE    512
+#endif
+#endif
+
+//=====[Declaration of public data types]======================================
+
+typedef struct uartTxStats {
+    uint32_t bytesQueued;
+    uint32_t bytesSent;
+    uint32_t messagesDropped;
+    uint32_t bytesDropped;
+    uint32_t maxBytesPending;
+} uartTxStats_t;
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+void uartTxInit(UnbufferedSerial* serial);
+
+// Queues a message for interrupt-driven transmission and returns at once.
+// A message that does not fit is dropped whole and counted in the stats.
+//
+// uartTxWriteConst() queues a reference only; the text must stay valid until
+// sent, which string literals always do. uartTxWrite() copies the bytes, for
+// text built in a local buffer.
+bool uartTxWriteConst(const char* str, size_t length);
+bool uartTxWrite(const char* data, size_t length);
+
+// Assembles one message directly in the copy buffer, piece by piece, with
+// no intermediate buffer. Nothing is sent until uartTxMessageEnd(); if the
+// pieces outgrow the free space the whole message is dropped there.
+// Producer side only, one message at a time.
+void uartTxMessageBegin();
+void uartTxMessagePut(const char* data, size_t length);
+void uartTxMessagePutChar(char byte);
+bool uartTxMessageEnd();
+
+size_t uartTxBytesPending();
+const uartTxStats_t* uartTxStatsGet();
+
+// Static RAM taken by the queues, for the footprint report
+uint32_t uartTxFootprintBytes();
+
+//=====[#include guards - end]=================================================
+
+#endif // _UART_TX_H_
@@ -0,0 +1,209 @@
+//=====[Libraries]=============================================================
+
+#include <stddef.h>
+
+#include "mbed.h"
+#include "FlashIAPBlockDevice.h"
+
+#include "crc16.h"
+#include "warm_start.h"
+
+//=====[Declaration of private defines]========================================
+
+#define WARM_START_MAGIC          0x57534132u   // "WSA2"
+#define WARM_START_MAX_SECTORS    8
+#define WARM_START_ALIGNMENT      4
+#define WARM_START_CHUNK_SIZE     64
+#define HEADER_SIZE               sizeof(warmStartHeader_t)
+
+//=====[Declaration of private data types]=====================================
+
+// Programmed before the state it describes, so a slot whose header is
+// still erased is free; crc covers the fields before it and then the state.
+typedef struct warmStartHeader {
+    uint32_t magic;
+    uint32_t sequence;
+    uint32_t layout;
+    uint32_t size;
+    uint32_t seconds;          // RTC time of the save
+    uint16_t crc;
+    uint16_t reserved;
+} warmStartHeader_t;
+
+//=====[Declaration and initialization of private global variables]============
+
+static FlashIAPBlockDevice warmStartDevice(WARM_START_FLASH_ADDRESS, WARM_START_FLASH_SIZE);
+
+static bool warmStartMounted = false;
+static uint32_t sectorSize = 0;
+static uint32_t numberOfSectors = 0;
+static bool newestFound = false;
+static uint32_t newestAddress = 0;
+static uint32_t newestSequence = 0;
+static uint32_t writeSector = 0;
+static uint32_t writeOffset = 0;        // sectorSize when the sector is full
+
+//=====[Declarations (prototypes) of private functions]========================
+
+static uint32_t recordSize(uint32_t stateSize);
+static bool recordCheck(uint32_t address, warmStartHeader_t* header);
+static bool headerIsErased(const warmStartHeader_t* header);
+static uint32_t sectorScan(uint32_t sector);
+
+//=====[Implementations of public functions]===================================
+
+bool warmStartInit()
+{
+    uint32_t freeOffsets[WARM_START_MAX_SECTORS];
+
+    warmStartMounted = false;
+    newestFound = false;
+    if (warmStartDevice.init() != 0) {
+        return false;
+    }
+    sectorSize = warmStartDevice.get_erase_size(0);
+    numberOfSectors = warmStartDevice.size() / sectorSize;
+    if (numberOfSectors < 2 || numberOfSectors > WARM_START_MAX_SECTORS ||
+        warmStartDevice.get_program_size() > WARM_START_ALIGNMENT) {
+        return false;
+    }
+
+    for (uint32_t sector = 0; sector < numberOfSectors; sector++) {
+        freeOffsets[sector] = sectorScan(sector);
+    }
+
+    // Continue after the newest record, or from the start if there is none
+    writeSector = newestFound ? newestAddress / sectorSize : 0;
+    writeOffset = freeOffsets[writeSector];
+    warmStartMounted = true;
+    return true;
+}
+
+bool warmStartLoad(uint32_t layout, void* state, uint32_t size, uint32_t* seconds)
+{
+    warmStartHeader_t header;
+
+    if (!warmStartMounted || !newestFound ||
+        warmStartDevice.read(&header, newestAddress, HEADER_SIZE) != 0 ||
+        header.layout != layout || header.size != size) {
+        return false;
+    }
+    *seconds = header.seconds;
+    return warmStartDevice.read(state, newestAddress + HEADER_SIZE, size) == 0;
+}
+
+bool warmStartSave(uint32_t layout, const void* state, uint32_t size)
+{
+    warmStartHeader_t header;
+    uint32_t length = recordSize(size);
+
+    if (!warmStartMounted || size > WARM_START_MAX_STATE_SIZE || length > sectorSize) {
+        return false;
+    }
+    if (writeOffset + length > sectorSize) {
+        // Never the sector holding the newest record, as there are two or more
+        uint32_t sector = (writeSector + 1) % numberOfSectors;
+        if (warmStartDevice.erase(sector * sectorSize, sectorSize) != 0) {
+            return false;
+        }
+        writeSector = sector;
+        writeOffset = 0;
+    }
+
+    header.magic = WARM_START_MAGIC;
+    header.sequence = newestSequence + 1;
+    header.layout = layout;
+    header.size = size;
+    header.seconds = (uint32_t)time(NULL);
+    header.crc = crc16Update(CRC16_INITIAL_VALUE, &header, offsetof(warmStartHeader_t, crc));
+    header.crc = crc16Update(header.crc, state, size);
+    header.reserved = 0xFFFF;
+
+    uint32_t address = writeSector * sectorSize + writeOffset;
+    writeOffset += length;
+    if (warmStartDevice.program(&header, address, HEADER_SIZE) != 0 ||
+        warmStartDevice.program(state, address + HEADER_SIZE, size) != 0) {
+        return false;
+    }
+    newestFound = true;
+    newestAddress = address;
+    newestSequence = header.sequence;
+    return true;
+}
+
+uint32_t warmStartSequence()
+{
+    return newestFound ? newestSequence : 0;
+}
+
+uint32_t warmStartFootprintBytes()
+{
+    return sizeof(warmStartDevice) + sizeof(newestAddress) + sizeof(newestSequence) +
+           sizeof(writeSector) + sizeof(writeOffset);
+}
+
+//=====[Implementations of private functions]==================================
+
+static uint32_t recordSize(uint32_t stateSize)
+{
+    return (HEADER_SIZE + stateSize + WARM_START_ALIGNMENT - 1) & ~(WARM_START_ALIGNMENT - 1);
+}
+
+// False for an erased, torn or foreign record.
+static bool recordCheck(uint32_t address, warmStartHeader_t* header)
+{
+    uint8_t chunk[WARM_START_CHUNK_SIZE];
+
+    memset(header, 0, HEADER_SIZE);
+    if (warmStartDevice.read(header, address, HEADER_SIZE) != 0 ||
+        header->magic != WARM_START_MAGIC || header->size > WARM_START_MAX_STATE_SIZE ||
+        address % sectorSize + recordSize(header->size) > sectorSize) {
+        return false;
+    }
+
+    uint16_t crc = crc16Update(CRC16_INITIAL_VALUE, header, offsetof(warmStartHeader_t, crc));
+    for (uint32_t done = 0; done < header->size; done += WARM_START_CHUNK_SIZE) {
+        uint32_t length = header->size - done < WARM_START_CHUNK_SIZE ?
+                          header->size - done : WARM_START_CHUNK_SIZE;
+        if (warmStartDevice.read(chunk, address + HEADER_SIZE + done, length) != 0) {
+            return false;
+        }
+        crc = crc16Update(crc, chunk, length);
+    }
+    return crc == header->crc;
+}
+
+// Updates the newest record with those of the sector and returns where its
+// free space starts. Anything after a record that does not check, e.g. one
+// torn by a reset, is left alone until the sector is next erased.
+static uint32_t sectorScan(uint32_t sector)
+{
+    warmStartHeader_t header;
+    uint32_t offset = 0;
+
+    while (offset + HEADER_SIZE <= sectorSize) {
+        uint32_t address = sector * sectorSize + offset;
+        if (!recordCheck(address, &header)) {
+            return headerIsErased(&header) ? offset : sectorSize;
+        }
+        if (!newestFound || (int32_t)(header.sequence - newestSequence) > 0) {
+            newestFound = true;
+            newestAddress = address;
+            newestSequence = header.sequence;
+        }
+        offset += recordSize(header.size);
+    }
+    return sectorSize;
+}
+
+static bool headerIsErased(const warmStartHeader_t* header)
+{
+    const uint8_t* bytes = (const uint8_t*)header;
+
+    for (size_t i = 0; i < HEADER_SIZE; i++) {
+        if (bytes[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
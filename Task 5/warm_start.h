@@ -0,0 +1,57 @@
+//=====[#include guards - begin]===============================================
+
+#ifndef _WARM_START_H_
+#define _WARM_START_H_
+
+//=====[Libraries]=============================================================
+
+#include <stdint.h>
+
+//=====[Declaration of public defines]=========================================
+
+// Flash region reserved for warm-start records: the two 128 KB sectors just
+// below the event journal. Must be a whole number of erase sectors, at
+// least two, so the newest record survives while a sector is erased.
+#ifndef WARM_START_FLASH_ADDRESS
+#define WARM_START_FLASH_ADDRESS    0x08180000
+#endif
+#ifndef WARM_START_FLASH_SIZE
+#define WARM_START_FLASH_SIZE       (256 * 1024)
+#endif
+
+#define WARM_START_MAX_STATE_SIZE   8192
+
+//=====[Declarations (prototypes) of public functions]=========================
+
+// Records are appended one after the other, each with a sequence number and
+// a CRC-16 over header and state, so a record torn by a reset is simply not
+// found. Writing moves on to the next sector when the current one is full,
+// erasing it first; the newest complete record is always kept.
+//
+// layout identifies the state's format and is stored with it; a record is
+// only restored into a state of the same layout and size. Each record also
+// carries the RTC time of its save, so the caller can tell how old it is.
+
+// Mounts the region and finds the newest valid record. Returns false if the
+// storage is not usable; saves and loads then fail.
+bool warmStartInit();
+
+// Copies the newest record into state and the RTC time it was saved at into
+// seconds. Returns false if there is none, or it was written with a
+// different layout or size.
+bool warmStartLoad(uint32_t layout, void* state, uint32_t size, uint32_t* seconds);
+
+// Appends a record. May wait for a sector erase, so call it from a thread
+// that can afford to block.
+bool warmStartSave(uint32_t layout, const void* state, uint32_t size);
+
+// Sequence number of the newest record, i.e. the number of saves so far
+uint32_t warmStartSequence();
+
+// Static RAM taken by the flash device and the write position, for the
+// footprint report
+uint32_t warmStartFootprintBytes();
+
+//=====[#include guards - end]=================================================
+
+#endif // _WARM_START_H_